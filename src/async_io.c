@@ -0,0 +1,306 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include "async_io.h"
+
+/*
+ * asynchronous read/write
+ *
+ * cubrid_backup_submit_read () / cubrid_restore_submit_write () 는 buffer 를 sq 에 넣고 바로 return 하며,
+ * handle 마다 하나인 worker thread 가 순서대로 처리해서 cq 에 넣는다.
+ * 그래서 동시에 걸리는 write 는 하나이고, 여러 개를 걸려면 worker 가 restore writer 에 넘기도록
+ * [restore] write_queue_depth 를 설정해야 한다.
+ * cubrid_backup_reap () / cubrid_restore_reap () 은 cq 에서 끝난 buffer 를 꺼낸다.
+ *
+ * sq, cq 는 lock 없이 head/tail 을 __ATOMIC_SEQ_CST 로 읽고 쓰며,
+ * 빈 ring -> data 가 될 때만 eventfd 로 상대편을 깨운다. (read_ahead.c 와 같은 방식)
+ * backup_mutex/restore_mutex 는 worker thread 를 처음 만들 때만 잡는다.
+ */
+
+/* returns 0 on timeout */
+static
+int wait_event_fd (int event_fd, int timeout_msecs)
+{
+    struct pollfd poll_fd;
+    int retval;
+
+    poll_fd.fd      = event_fd;
+    poll_fd.events  = POLLIN;
+    poll_fd.revents = 0;
+
+    retval = poll (&poll_fd, 1, timeout_msecs);
+
+    if (retval == -1)
+    {
+        if (errno == EINTR)
+        {
+            return 1;
+        }
+
+        PRINT_LOG_ERR (ERR_INFO);
+        return -1;
+    }
+
+    if (retval == 1)
+    {
+        drain_event_fd (event_fd);
+    }
+
+    return retval;
+}
+
+static
+void publish_completion (ASYNC_IO* async_io, ASYNC_IO_ENTRY* entry)
+{
+    unsigned long long cq_head = __atomic_load_n (&async_io->cq_head, __ATOMIC_SEQ_CST);
+
+    async_io->cq[cq_head % MAX_ASYNC_IO_DEPTH] = *entry;
+
+    __atomic_store_n (&async_io->cq_head, cq_head + 1, __ATOMIC_SEQ_CST);
+
+    // reaper 가 비어 있는 cq 를 보고 잠들었을 수 있다.
+    if (__atomic_load_n (&async_io->cq_tail, __ATOMIC_SEQ_CST) == cq_head)
+    {
+        signal_event_fd (async_io->cq_event_fd);
+    }
+}
+
+static
+void* serve_async_io (void* arg)
+{
+    ASYNC_IO* async_io = (ASYNC_IO *)arg;
+    ASYNC_IO_ENTRY* entry;
+    unsigned long long sq_tail;
+
+    while (__atomic_load_n (&async_io->is_stop, __ATOMIC_SEQ_CST) == false)
+    {
+        sq_tail = __atomic_load_n (&async_io->sq_tail, __ATOMIC_SEQ_CST);
+
+        if (__atomic_load_n (&async_io->sq_head, __ATOMIC_SEQ_CST) == sq_tail)
+        {
+            if (-1 == wait_event_fd (async_io->sq_event_fd, -1))
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        entry = &async_io->sq[sq_tail % MAX_ASYNC_IO_DEPTH];
+
+        entry->data_len = 0;
+        entry->result   = async_io->io_func (async_io->handle, entry);
+
+        __atomic_store_n (&async_io->sq_tail, sq_tail + 1, __ATOMIC_SEQ_CST);
+
+        publish_completion (async_io, entry);
+    }
+
+    return NULL;
+}
+
+int start_async_io (void* handle, ASYNC_IO_FUNC io_func, ASYNC_IO** async_io_out)
+{
+    ASYNC_IO* async_io;
+
+    int state = 0;
+
+    async_io = (ASYNC_IO *)malloc (sizeof (ASYNC_IO));
+
+    if (IS_NULL (async_io))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    async_io->handle  = handle;
+    async_io->io_func = io_func;
+    async_io->sq_head = 0;
+    async_io->sq_tail = 0;
+    async_io->cq_head = 0;
+    async_io->cq_tail = 0;
+    async_io->is_stop = false;
+
+    async_io->sq_event_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (async_io->sq_event_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 2;
+
+    async_io->cq_event_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (async_io->cq_event_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 3;
+
+    if (IS_FAILURE (pthread_create (&async_io->worker_thread, NULL, serve_async_io, async_io)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    *async_io_out = async_io;
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 3:
+            close (async_io->cq_event_fd);
+        case 2:
+            close (async_io->sq_event_fd);
+        case 1:
+            free (async_io);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/*
+ * worker thread 를 멈추고 아직 처리하지 않은 submission 은 버린다.
+ * worker thread 가 처리 중인 read 가 끝날 수 있도록 backup process 를 먼저 정리한 뒤에 호출한다.
+ */
+void stop_async_io (ASYNC_IO** async_io_ptr)
+{
+    ASYNC_IO* async_io = *async_io_ptr;
+
+    if (IS_NULL (async_io))
+    {
+        return;
+    }
+
+    __atomic_store_n (&async_io->is_stop, true, __ATOMIC_SEQ_CST);
+
+    signal_event_fd (async_io->sq_event_fd);
+
+    pthread_join (async_io->worker_thread, NULL);
+
+    close (async_io->cq_event_fd);
+    close (async_io->sq_event_fd);
+
+    free (async_io);
+
+    __atomic_store_n (async_io_ptr, NULL, __ATOMIC_RELEASE);
+}
+
+/* returns SUCCESS_WOULDBLOCK if MAX_ASYNC_IO_DEPTH buffers are already in flight */
+int submit_async_io (ASYNC_IO* async_io, ASYNC_IO_ENTRY* entry)
+{
+    unsigned long long sq_head = __atomic_load_n (&async_io->sq_head, __ATOMIC_SEQ_CST);
+
+    if (sq_head - __atomic_load_n (&async_io->cq_tail, __ATOMIC_SEQ_CST) >= MAX_ASYNC_IO_DEPTH)
+    {
+        return SUCCESS_WOULDBLOCK;
+    }
+
+    async_io->sq[sq_head % MAX_ASYNC_IO_DEPTH] = *entry;
+
+    __atomic_store_n (&async_io->sq_head, sq_head + 1, __ATOMIC_SEQ_CST);
+
+    // worker thread 가 비어 있는 sq 를 보고 잠들었을 수 있다.
+    if (__atomic_load_n (&async_io->sq_tail, __ATOMIC_SEQ_CST) == sq_head)
+    {
+        signal_event_fd (async_io->sq_event_fd);
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * 끝난 buffer 를 max_count 개까지 completions 에 꺼낸다.
+ * timeout_msecs: -1 은 하나라도 끝날 때까지, 0 은 기다리지 않는다.
+ * in flight 인 buffer 가 없으면 기다리지 않고 *count = 0 으로 return 한다.
+ */
+int reap_async_io (ASYNC_IO* async_io, CUBRID_IO_COMPLETION* completions, unsigned int max_count, int timeout_msecs, unsigned int* count)
+{
+    struct timespec deadline;
+    struct timespec now;
+    unsigned long long cq_tail;
+    unsigned long long cq_head;
+    ASYNC_IO_ENTRY* entry;
+    int remain_msecs = timeout_msecs;
+    unsigned int i;
+
+    *count = 0;
+
+    if (timeout_msecs > 0)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &deadline);
+
+        deadline.tv_sec  += timeout_msecs / 1000;
+        deadline.tv_nsec += (timeout_msecs % 1000) * 1000000L;
+
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec  += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    cq_tail = __atomic_load_n (&async_io->cq_tail, __ATOMIC_SEQ_CST);
+
+    while (1)
+    {
+        cq_head = __atomic_load_n (&async_io->cq_head, __ATOMIC_SEQ_CST);
+
+        if (cq_head != cq_tail)
+        {
+            break;
+        }
+
+        if (__atomic_load_n (&async_io->sq_head, __ATOMIC_SEQ_CST) == cq_tail || IS_ZERO (remain_msecs))
+        {
+            return SUCCESS;
+        }
+
+        if (-1 == wait_event_fd (async_io->cq_event_fd, remain_msecs))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            return FAILURE;
+        }
+
+        if (timeout_msecs > 0)
+        {
+            clock_gettime (CLOCK_MONOTONIC, &now);
+
+            remain_msecs = (deadline.tv_sec - now.tv_sec) * 1000 + (deadline.tv_nsec - now.tv_nsec) / 1000000;
+
+            if (remain_msecs < 0)
+            {
+                remain_msecs = 0;
+            }
+        }
+    }
+
+    for (i = 0; i < max_count && cq_tail + i != cq_head; i ++)
+    {
+        entry = &async_io->cq[(cq_tail + i) % MAX_ASYNC_IO_DEPTH];
+
+        completions[i].buffer    = entry->buffer;
+        completions[i].user_data = entry->user_data;
+        completions[i].data_len  = entry->data_len;
+        completions[i].result    = entry->result;
+    }
+
+    __atomic_store_n (&async_io->cq_tail, cq_tail + i, __ATOMIC_SEQ_CST);
+
+    *count = i;
+
+    return SUCCESS;
+}
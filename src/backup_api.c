@@ -2,6 +2,7 @@
 #include "backup_core.h"
 #include "backup_manager.h"
 #include "handle_manager.h"
+#include "process_manager.h"
 
 int cubrid_backup_initialize (void)
 {
@@ -29,12 +30,22 @@ int cubrid_backup_initialize (void)
 
     state = 3;
 
+    if (IS_FAILURE (start_process_manager ()))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 4;
+
     if (IS_FAILURE (start_handle_manager ()))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
+    state = 5;
+
     if (IS_FAILURE (transit_backup_api_state (BACKUP_API_STATE_INITIALIZING, BACKUP_API_STATE_READY)))
     {
         PRINT_LOG_ERR (ERR_INFO);
@@ -51,8 +62,11 @@ error:
 
     switch (state)
     {
-        case 3:
+        case 5:
             stop_handle_manager ();
+        case 4:
+            stop_process_manager ();
+        case 3:
         case 2:
             stop_backup_manager ();
         case 1:
@@ -82,6 +96,12 @@ int cubrid_backup_finalize (void)
         goto error;
     }
 
+    if (IS_FAILURE (stop_process_manager ()))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
     if (IS_FAILURE (stop_backup_manager ()))
     {
         PRINT_LOG_ERR (ERR_INFO);
@@ -101,8 +121,6 @@ error:
 
 int cubrid_backup_begin (CUBRID_BACKUP_INFO* backup_info, void** backup_handle)
 {
-    int state = 0;
-
 #if 0
     PRINT_LOG_INFO ("cubrid_backup_begin (), backup_level => %d, db_name => %s\n",
                     backup_info->backup_level,
@@ -115,8 +133,6 @@ int cubrid_backup_begin (CUBRID_BACKUP_INFO* backup_info, void** backup_handle)
         goto error;
     }
 
-    state = 1;
-
     if (IS_FAILURE (begin_backup (backup_info, backup_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
@@ -140,14 +156,6 @@ int cubrid_backup_begin (CUBRID_BACKUP_INFO* backup_info, void** backup_handle)
 
 error:
 
-    switch (state)
-    {
-        case 1:
-            transit_backup_api_state (BACKUP_API_STATE_BACKUP_SERVICE, BACKUP_API_STATE_READY);
-        default:
-            break;
-    }
-
     return FAILURE;
 }
 
@@ -172,9 +180,125 @@ int cubrid_backup_end (void* backup_handle)
         goto error;
     }
 
-    if (IS_FAILURE (transit_backup_api_state (BACKUP_API_STATE_BACKUP_SERVICE, BACKUP_API_STATE_READY)))
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_backup_cancel (void* backup_handle)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_backup_cancel (), backup_handle => %p\n", backup_handle);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_CANCEL)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (cancel_backup (backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_backup_cancel (), backup_handle => %p\n", backup_handle);
+
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_backup_run (void* backup_handle, CUBRID_BACKUP_SINK sink_cb, void* ctx, unsigned int buffer_size, unsigned int nbuffers)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_backup_run (), backup_handle => %p, sink_cb => %p, ctx => %p, buffer_size => %u, nbuffers => %u\n",
+                    backup_handle,
+                    sink_cb,
+                    ctx,
+                    buffer_size,
+                    nbuffers);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_RUN)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (run_backup (backup_handle, sink_cb, ctx, buffer_size, nbuffers)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_backup_run (), backup_handle => %p, sink_cb => %p, ctx => %p, buffer_size => %u, nbuffers => %u\n",
+                        backup_handle,
+                        sink_cb,
+                        ctx,
+                        buffer_size,
+                        nbuffers);
+
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_backup_set_read_lowat (void* backup_handle, unsigned int read_lowat)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_backup_set_read_lowat (), backup_handle => %p, read_lowat => %u\n", backup_handle, read_lowat);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_SET_READ_LOWAT)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (set_read_lowat (backup_handle, read_lowat)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_backup_set_read_lowat (), backup_handle => %p, read_lowat => %u\n", backup_handle, read_lowat);
+
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_backup_set_pipe_size (void* backup_handle, int pipe_size)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_backup_set_pipe_size (), backup_handle => %p, pipe_size => %d\n", backup_handle, pipe_size);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_SET_PIPE_SIZE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (set_backup_pipe_size (backup_handle, pipe_size)))
     {
         PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_backup_set_pipe_size (), backup_handle => %p, pipe_size => %d\n", backup_handle, pipe_size);
+
         goto error;
     }
 
@@ -202,7 +326,7 @@ int cubrid_backup_read (void* backup_handle, void* buffer, unsigned int buffer_s
         goto error;
     }
 
-    if (IS_FAILURE (read_backup_data (backup_handle, buffer, buffer_size, data_len, &is_backup_end)))
+    if (IS_FAILURE (read_backup_data (backup_handle, buffer, buffer_size, data_len, -1, &is_backup_end)))
     {
         PRINT_LOG_ERR (ERR_INFO);
 
@@ -233,122 +357,674 @@ error:
     return FAILURE;
 }
 
-int cubrid_restore_begin (CUBRID_RESTORE_INFO* restore_info, void** restore_handle)
+int cubrid_backup_read_with_timeout (void* backup_handle, void* buffer, unsigned int buffer_size, unsigned int* data_len, int timeout_msecs)
 {
-    int state = 0;
-
+    bool is_backup_end = false;
 #if 0
-    PRINT_LOG_INFO ("cubrid_restore_begin (), restore_type => %d, backup_level => %d, backup_file_path => %s, db_name => %s\n",
-                    restore_info->restore_type,
-                    restore_info->backup_level,
-                    restore_info->backup_file_path,
-                    restore_info->db_name);
+    PRINT_LOG_INFO ("cubrid_backup_read_with_timeout (), backup_handle => %p, buffer => %p, buffer_size => %d, data_len => %p, timeout_msecs => %d\n",
+                    backup_handle,
+                    buffer,
+                    buffer_size,
+                    data_len,
+                    timeout_msecs);
 #endif
 
-    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_BEGIN)))
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_READ)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    state = 1;
-
-    if (IS_FAILURE (begin_restore (restore_info, restore_handle)))
+    if (IS_FAILURE (read_backup_data (backup_handle, buffer, buffer_size, data_len, timeout_msecs, &is_backup_end)))
     {
         PRINT_LOG_ERR (ERR_INFO);
 
-        PRINT_LOG_INFO ("cubrid_restore_begin (), restore_type => %d, backup_level => %d, backup_file_path => %s, db_name => %s\n",
-                        restore_info->restore_type,
-                        restore_info->backup_level,
-                        restore_info->backup_file_path,
-                        restore_info->db_name);
+        PRINT_LOG_INFO ("cubrid_backup_read_with_timeout (), backup_handle => %p, buffer => %p, buffer_size => %d, data_len => %p, timeout_msecs => %d\n",
+                        backup_handle,
+                        buffer,
+                        buffer_size,
+                        data_len,
+                        timeout_msecs);
 
         goto error;
     }
 
 #if 0
-    PRINT_LOG_INFO ("cubrid_restore_begin (), restore_handle => %p\n", *restore_handle);
+    PRINT_LOG_INFO ("cubrid_backup_read_with_timeout (), data_len => %d\n", *data_len);
 #endif
 
-    return SUCCESS;
+    if (is_backup_end == true)
+    {
+        return SUCCESS;
+    }
+    else
+    {
+        return SUCCESS_FRAGMENTED;
+    }
 
 error:
 
-    switch (state)
+    return FAILURE;
+}
+
+int cubrid_backup_read_to_fd (void* backup_handle, int out_fd, unsigned int max_bytes, unsigned int* moved)
+{
+    bool is_backup_end = false;
+#if 0
+    PRINT_LOG_INFO ("cubrid_backup_read_to_fd (), backup_handle => %p, out_fd => %d, max_bytes => %d, moved => %p\n",
+                    backup_handle,
+                    out_fd,
+                    max_bytes,
+                    moved);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_READ)))
     {
-        case 1:
-            transit_backup_api_state (BACKUP_API_STATE_RESTORE_SERVICE, BACKUP_API_STATE_READY);
-        default:
-            break;
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (read_backup_data_to_fd (backup_handle, out_fd, max_bytes, moved, &is_backup_end)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_backup_read_to_fd (), backup_handle => %p, out_fd => %d, max_bytes => %d, moved => %p\n",
+                        backup_handle,
+                        out_fd,
+                        max_bytes,
+                        moved);
+
+        goto error;
+    }
+
+    if (is_backup_end == true)
+    {
+        return SUCCESS;
+    }
+    else
+    {
+        return SUCCESS_FRAGMENTED;
     }
 
+error:
+
     return FAILURE;
 }
 
-int cubrid_restore_end (void* restore_handle)
+int cubrid_backup_get_pollfd (void* backup_handle)
 {
+    int poll_fd;
 #if 0
-    PRINT_LOG_INFO ("cubrid_restore_end (), restore_handle => %p\n", restore_handle);
+    PRINT_LOG_INFO ("cubrid_backup_get_pollfd (), backup_handle => %p\n", backup_handle);
 #endif
 
-    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_END)))
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_GET_POLLFD)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (end_restore (restore_handle)))
+    if (IS_FAILURE (get_backup_pollfd (backup_handle, &poll_fd)))
     {
         PRINT_LOG_ERR (ERR_INFO);
 
-        PRINT_LOG_INFO ("cubrid_restore_end (), restore_handle => %p\n", restore_handle);
+        PRINT_LOG_INFO ("cubrid_backup_get_pollfd (), backup_handle => %p\n", backup_handle);
+
+        goto error;
+    }
+
+    return poll_fd;
+
+error:
+
+    return -1;
+}
+
+int cubrid_backup_read_nb (void* backup_handle, void* buffer, unsigned int buffer_size, unsigned int* data_len)
+{
+    bool is_backup_end = false;
+#if 0
+    PRINT_LOG_INFO ("cubrid_backup_read_nb (), backup_handle => %p, buffer => %p, buffer_size => %d, data_len => %p\n",
+                    backup_handle,
+                    buffer,
+                    buffer_size,
+                    data_len);
+#endif
 
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_READ)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (transit_backup_api_state (BACKUP_API_STATE_RESTORE_SERVICE, BACKUP_API_STATE_READY)))
+    if (IS_FAILURE (read_backup_data (backup_handle, buffer, buffer_size, data_len, 0, &is_backup_end)))
     {
         PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_backup_read_nb (), backup_handle => %p, buffer => %p, buffer_size => %d, data_len => %p\n",
+                        backup_handle,
+                        buffer,
+                        buffer_size,
+                        data_len);
+
         goto error;
     }
 
-    return SUCCESS;
+    if (is_backup_end == true)
+    {
+        return SUCCESS;
+    }
+    else if (IS_ZERO (*data_len))
+    {
+        return SUCCESS_WOULDBLOCK;
+    }
+    else
+    {
+        return SUCCESS_FRAGMENTED;
+    }
 
 error:
 
     return FAILURE;
 }
 
-int cubrid_restore_write (void* restore_handle, int backup_level, void* buffer, unsigned int data_len)
+int cubrid_backup_submit_read (void* backup_handle, void* buffer, unsigned int buffer_size, void* user_data)
 {
+    int retval;
 #if 0
-    PRINT_LOG_INFO ("cubrid_restore_write (), restore_handle => %p, backup_level => %d, buffer => %p, data_len => %d\n",
-                    restore_handle,
-                    backup_level,
+    PRINT_LOG_INFO ("cubrid_backup_submit_read (), backup_handle => %p, buffer => %p, buffer_size => %d, user_data => %p\n",
+                    backup_handle,
                     buffer,
-                    data_len);
+                    buffer_size,
+                    user_data);
 #endif
 
-    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_WRITE)))
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_READ)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (write_backup_data (restore_handle, backup_level, buffer, data_len)))
+    retval = submit_backup_read (backup_handle, buffer, buffer_size, user_data);
+
+    if (retval == FAILURE)
     {
         PRINT_LOG_ERR (ERR_INFO);
 
-        PRINT_LOG_INFO ("cubrid_restore_write (), restore_handle => %p, backup_level => %d, buffer => %p, data_len => %d\n",
-                        restore_handle,
-                        backup_level,
+        PRINT_LOG_INFO ("cubrid_backup_submit_read (), backup_handle => %p, buffer => %p, buffer_size => %d, user_data => %p\n",
+                        backup_handle,
                         buffer,
-                        data_len);
+                        buffer_size,
+                        user_data);
 
         goto error;
     }
 
-    return SUCCESS;
+    return retval;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_backup_reap (void* backup_handle, CUBRID_IO_COMPLETION* completions, unsigned int max_count, int timeout_msecs)
+{
+    unsigned int count;
+#if 0
+    PRINT_LOG_INFO ("cubrid_backup_reap (), backup_handle => %p, completions => %p, max_count => %u, timeout_msecs => %d\n",
+                    backup_handle,
+                    completions,
+                    max_count,
+                    timeout_msecs);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_BACKUP_READ)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (reap_backup_data (backup_handle, completions, max_count, timeout_msecs, &count)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_backup_reap (), backup_handle => %p, completions => %p, max_count => %u, timeout_msecs => %d\n",
+                        backup_handle,
+                        completions,
+                        max_count,
+                        timeout_msecs);
+
+        goto error;
+    }
+
+    return count;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_begin (CUBRID_RESTORE_INFO* restore_info, void** restore_handle)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_begin (), restore_type => %d, backup_level => %d, backup_file_path => %s, db_name => %s\n",
+                    restore_info->restore_type,
+                    restore_info->backup_level,
+                    restore_info->backup_file_path,
+                    restore_info->db_name);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_BEGIN)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (begin_restore (restore_info, false, restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_begin (), restore_type => %d, backup_level => %d, backup_file_path => %s, db_name => %s\n",
+                        restore_info->restore_type,
+                        restore_info->backup_level,
+                        restore_info->backup_file_path,
+                        restore_info->db_name);
+
+        goto error;
+    }
+
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_begin (), restore_handle => %p\n", *restore_handle);
+#endif
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_begin_resumable (CUBRID_RESTORE_INFO* restore_info, void** restore_handle)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_begin_resumable (), restore_type => %d, backup_level => %d, backup_file_path => %s, db_name => %s\n",
+                    restore_info->restore_type,
+                    restore_info->backup_level,
+                    restore_info->backup_file_path,
+                    restore_info->db_name);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_BEGIN)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (begin_restore (restore_info, true, restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_begin_resumable (), restore_type => %d, backup_level => %d, backup_file_path => %s, db_name => %s\n",
+                        restore_info->restore_type,
+                        restore_info->backup_level,
+                        restore_info->backup_file_path,
+                        restore_info->db_name);
+
+        goto error;
+    }
+
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_begin_resumable (), restore_handle => %p\n", *restore_handle);
+#endif
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_end (void* restore_handle)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_end (), restore_handle => %p\n", restore_handle);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_END)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (end_restore (restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_end (), restore_handle => %p\n", restore_handle);
+
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_write (void* restore_handle, int backup_level, void* buffer, unsigned int data_len)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_write (), restore_handle => %p, backup_level => %d, buffer => %p, data_len => %d\n",
+                    restore_handle,
+                    backup_level,
+                    buffer,
+                    data_len);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_WRITE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (write_backup_data (restore_handle, backup_level, buffer, data_len)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_write (), restore_handle => %p, backup_level => %d, buffer => %p, data_len => %d\n",
+                        restore_handle,
+                        backup_level,
+                        buffer,
+                        data_len);
+
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_write_volume (void* restore_handle, int backup_level, int volume_index, void* buffer, unsigned int data_len)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_write_volume (), restore_handle => %p, backup_level => %d, volume_index => %d, buffer => %p, data_len => %d\n",
+                    restore_handle,
+                    backup_level,
+                    volume_index,
+                    buffer,
+                    data_len);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_WRITE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (write_backup_volume_data (restore_handle, backup_level, volume_index, buffer, data_len)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_write_volume (), restore_handle => %p, backup_level => %d, volume_index => %d, buffer => %p, data_len => %d\n",
+                        restore_handle,
+                        backup_level,
+                        volume_index,
+                        buffer,
+                        data_len);
+
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_pwrite (void* restore_handle, int backup_level, long long offset, void* buffer, unsigned int data_len)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_pwrite (), restore_handle => %p, backup_level => %d, offset => %lld, buffer => %p, data_len => %d\n",
+                    restore_handle,
+                    backup_level,
+                    offset,
+                    buffer,
+                    data_len);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_WRITE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pwrite_backup_data (restore_handle, backup_level, offset, buffer, data_len)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_pwrite (), restore_handle => %p, backup_level => %d, offset => %lld, buffer => %p, data_len => %d\n",
+                        restore_handle,
+                        backup_level,
+                        offset,
+                        buffer,
+                        data_len);
+
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_get_pollfd (void* restore_handle)
+{
+    int poll_fd;
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_get_pollfd (), restore_handle => %p\n", restore_handle);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_GET_POLLFD)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (get_restore_pollfd (restore_handle, &poll_fd)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_get_pollfd (), restore_handle => %p\n", restore_handle);
+
+        goto error;
+    }
+
+    return poll_fd;
+
+error:
+
+    return -1;
+}
+
+long long cubrid_restore_get_resume_offset (void* restore_handle)
+{
+    long long resume_offset;
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_get_resume_offset (), restore_handle => %p\n", restore_handle);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_GET_RESUME_OFFSET)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (get_resume_offset (restore_handle, &resume_offset)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_get_resume_offset (), restore_handle => %p\n", restore_handle);
+
+        goto error;
+    }
+
+    return resume_offset;
+
+error:
+
+    return -1;
+}
+
+int cubrid_restore_set_expected_size (void* restore_handle, long long expected_size)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_set_expected_size (), restore_handle => %p, expected_size => %lld\n", restore_handle, expected_size);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_SET_EXPECTED_SIZE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (set_expected_size (restore_handle, expected_size)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_set_expected_size (), restore_handle => %p, expected_size => %lld\n", restore_handle, expected_size);
+
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_write_nb (void* restore_handle, int backup_level, void* buffer, unsigned int data_len, unsigned int* written)
+{
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_write_nb (), restore_handle => %p, backup_level => %d, buffer => %p, data_len => %d, written => %p\n",
+                    restore_handle,
+                    backup_level,
+                    buffer,
+                    data_len,
+                    written);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_WRITE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (write_backup_data_nb (restore_handle, backup_level, buffer, data_len, written)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_write_nb (), restore_handle => %p, backup_level => %d, buffer => %p, data_len => %d, written => %p\n",
+                        restore_handle,
+                        backup_level,
+                        buffer,
+                        data_len,
+                        written);
+
+        goto error;
+    }
+
+    if (IS_ZERO (*written) && data_len != 0)
+    {
+        return SUCCESS_WOULDBLOCK;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_submit_write (void* restore_handle, int backup_level, void* buffer, unsigned int data_len, void* user_data)
+{
+    int retval;
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_submit_write (), restore_handle => %p, backup_level => %d, buffer => %p, data_len => %d, user_data => %p\n",
+                    restore_handle,
+                    backup_level,
+                    buffer,
+                    data_len,
+                    user_data);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_WRITE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    retval = submit_backup_write (restore_handle, backup_level, buffer, data_len, user_data);
+
+    if (retval == FAILURE)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_submit_write (), restore_handle => %p, backup_level => %d, buffer => %p, data_len => %d, user_data => %p\n",
+                        restore_handle,
+                        backup_level,
+                        buffer,
+                        data_len,
+                        user_data);
+
+        goto error;
+    }
+
+    return retval;
+
+error:
+
+    return FAILURE;
+}
+
+int cubrid_restore_reap (void* restore_handle, CUBRID_IO_COMPLETION* completions, unsigned int max_count, int timeout_msecs)
+{
+    unsigned int count;
+#if 0
+    PRINT_LOG_INFO ("cubrid_restore_reap (), restore_handle => %p, completions => %p, max_count => %u, timeout_msecs => %d\n",
+                    restore_handle,
+                    completions,
+                    max_count,
+                    timeout_msecs);
+#endif
+
+    if (IS_FAILURE (check_api_call_sequence (FUNC_CALL_RESTORE_WRITE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (reap_restore_data (restore_handle, completions, max_count, timeout_msecs, &count)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        PRINT_LOG_INFO ("cubrid_restore_reap (), restore_handle => %p, completions => %p, max_count => %u, timeout_msecs => %d\n",
+                        restore_handle,
+                        completions,
+                        max_count,
+                        timeout_msecs);
+
+        goto error;
+    }
+
+    return count;
 
 error:
 
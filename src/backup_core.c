@@ -1,14 +1,50 @@
+#include <stdlib.h>
 #include <sys/wait.h>
 #include <errno.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "async_io.h"
 #include "backup_api.h"
 #include "backup_core.h"
 #include "backup_manager.h"
 #include "handle_manager.h"
+#include "process_manager.h"
+#include "read_ahead.h"
+#include "restore_writer.h"
+
+#define GIGABYTE (1024.0 * 1024.0 * 1024.0)
+
+#define SPLICE_BOUNCE_BUFFER_SIZE (64 * 1024)
+
+/* transfer_fifo () / transfer_ring (): writing to out_fd failed, unlike -1 (EAGAIN) this is not an empty fifo */
+#define TRANSFER_OUT_FD_ERROR (-2)
+
+/* RESTORE_TO_DB: retry interval of opening the fifo until cubrid restoredb opens it */
+#define RESTORE_FIFO_OPEN_INTERVAL_MSECS (10)
+
+/* RESTORE_TO_DB: cubrid_restore_begin () fails if cubrid restoredb neither opens the fifo nor exits by then */
+#define RESTORE_FIFO_OPEN_TIMEOUT_MSECS (60 * 1000)
+
+/* RESTORE_TO_DB: progress is logged whenever this much more is written to cubrid restoredb */
+#define RESTORE_PROGRESS_LOG_SIZE (1024LL * 1024 * 1024)
+
+/* destination of the data read from the backup fifo */
+typedef struct read_target READ_TARGET;
+struct read_target
+{
+    char* buffer; /* NULL: move the data to out_fd */
+    int out_fd;
+    bool use_splice;
+};
 
 pthread_once_t backup_api_once_initialize = PTHREAD_ONCE_INIT;
 pthread_once_t backup_api_once_finalize   = PTHREAD_ONCE_INIT;
 
 pthread_mutex_t backup_api_state_mutex;
+
+/* written under backup_api_state_mutex, read lock-free by the per-call checks */
 BACKUP_API_STATE backup_api_state = BACKUP_API_STATE_NOT_READY;
 
 void initialize_backup_api (void)
@@ -26,7 +62,7 @@ void finalize_backup_api (void)
         backup_api_once_initialize = PTHREAD_ONCE_INIT;
     }
 
-    backup_api_state = BACKUP_API_STATE_NOT_READY;
+    __atomic_store_n (&backup_api_state, BACKUP_API_STATE_NOT_READY, __ATOMIC_RELEASE);
 }
 
 int transit_backup_api_state (BACKUP_API_STATE state_now, BACKUP_API_STATE state_where)
@@ -53,7 +89,7 @@ int transit_backup_api_state (BACKUP_API_STATE state_now, BACKUP_API_STATE state
         goto error;
     }
 
-    backup_api_state = state_where;
+    __atomic_store_n (&backup_api_state, state_where, __ATOMIC_RELEASE);
 
     if (IS_FAILURE (pthread_mutex_unlock (&backup_api_state_mutex)))
     {
@@ -102,7 +138,7 @@ int transit_backup_api_state_to_end (void)
         goto error;
     }
 
-    backup_api_state = BACKUP_API_STATE_FINALIZING;
+    __atomic_store_n (&backup_api_state, BACKUP_API_STATE_FINALIZING, __ATOMIC_RELEASE);
 
     if (IS_FAILURE (pthread_mutex_unlock (&backup_api_state_mutex)))
     {
@@ -125,6 +161,8 @@ error:
     return FAILURE;
 }
 
+// begin/end/read/write 는 global state 를 읽기만 하므로 lock 을 잡지 않는다.
+// session 상태는 각 handle 의 handle_state 에서 관리한다.
 static
 int check_backup_api_state (BACKUP_API_STATE state_now)
 {
@@ -134,19 +172,7 @@ int check_backup_api_state (BACKUP_API_STATE state_now)
         goto error;
     }
 
-    if (IS_FAILURE (pthread_mutex_lock (&backup_api_state_mutex)))
-    {
-        PRINT_LOG_ERR (ERR_INFO);
-        goto error;
-    }
-
-    if (backup_api_state != state_now)
-    {
-        PRINT_LOG_ERR (ERR_INFO);
-        goto error;
-    }
-
-    if (IS_FAILURE (pthread_mutex_unlock (&backup_api_state_mutex)))
+    if (__atomic_load_n (&backup_api_state, __ATOMIC_ACQUIRE) != state_now)
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
@@ -156,8 +182,6 @@ int check_backup_api_state (BACKUP_API_STATE state_now)
 
 error:
 
-    pthread_mutex_unlock (&backup_api_state_mutex);
-
     return FAILURE;
 }
 
@@ -184,36 +208,20 @@ int check_api_call_sequence (FUNC_CALL func_call)
             break;
 
         case FUNC_CALL_BACKUP_BEGIN:
-            if (IS_FAILURE (transit_backup_api_state (BACKUP_API_STATE_READY, BACKUP_API_STATE_BACKUP_SERVICE)))
-            {
-                PRINT_LOG_ERR (ERR_INFO);
-                goto error;
-            }
-
-            break;
-
         case FUNC_CALL_BACKUP_END:
         case FUNC_CALL_BACKUP_READ:
-            if (IS_FAILURE (check_backup_api_state (BACKUP_API_STATE_BACKUP_SERVICE)))
-            {
-                PRINT_LOG_ERR (ERR_INFO);
-                goto error;
-            }
-
-            break;
-
+        case FUNC_CALL_BACKUP_CANCEL:
+        case FUNC_CALL_BACKUP_SET_READ_LOWAT:
+        case FUNC_CALL_BACKUP_SET_PIPE_SIZE:
+        case FUNC_CALL_BACKUP_RUN:
+        case FUNC_CALL_BACKUP_GET_POLLFD:
         case FUNC_CALL_RESTORE_BEGIN:
-            if (IS_FAILURE (transit_backup_api_state (BACKUP_API_STATE_READY, BACKUP_API_STATE_RESTORE_SERVICE)))
-            {
-                PRINT_LOG_ERR (ERR_INFO);
-                goto error;
-            }
-
-            break;
-
         case FUNC_CALL_RESTORE_END:
         case FUNC_CALL_RESTORE_WRITE:
-            if (IS_FAILURE (check_backup_api_state (BACKUP_API_STATE_RESTORE_SERVICE)))
+        case FUNC_CALL_RESTORE_GET_POLLFD:
+        case FUNC_CALL_RESTORE_GET_RESUME_OFFSET:
+        case FUNC_CALL_RESTORE_SET_EXPECTED_SIZE:
+            if (IS_FAILURE (check_backup_api_state (BACKUP_API_STATE_READY)))
             {
                 PRINT_LOG_ERR (ERR_INFO);
                 goto error;
@@ -344,6 +352,8 @@ int set_backup_info (CUBRID_BACKUP_INFO* backup_info, BACKUP_HANDLE* backup_hand
         backup_handle->compress = backup_info->compress == 1 ? true : false;
     }
 
+    backup_handle->pipe_size = backup_opt->pipe_size;
+
     snprintf (backup_handle->db_name, MAX_DB_NAME_LEN + 1, "%s", backup_info->db_name);
 
     return SUCCESS;
@@ -354,17 +364,27 @@ error:
 }
 
 static
-int check_restore_info (CUBRID_RESTORE_INFO* restore_info)
+int check_restore_info (CUBRID_RESTORE_INFO* restore_info, bool is_resumable)
 {
-    if (/* restore_info->restore_type != RESTORE_TO_DB || */
+    if (restore_info->restore_type != RESTORE_TO_DB &&
         restore_info->restore_type != RESTORE_TO_FILE)
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (restore_info->backup_level < BACKUP_FULL_LEVEL ||
-        restore_info->backup_level > BACKUP_SMALL_INCREMENT_LEVEL)
+    if (restore_info->backup_level == CUBRID_RESTORE_ALL_LEVELS)
+    {
+        // cubrid restoredb 는 하나의 level 까지 restore 한다.
+        if (restore_info->restore_type == RESTORE_TO_DB)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+    }
+    else if (restore_info->backup_level < BACKUP_FULL_LEVEL ||
+             restore_info->backup_level > BACKUP_SMALL_INCREMENT_LEVEL)
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
@@ -377,6 +397,14 @@ int check_restore_info (CUBRID_RESTORE_INFO* restore_info)
     }
 #endif
 
+    // checkpoint 는 level 하나의 restore file 에 대해서만 남긴다.
+    if (is_resumable == true &&
+        (restore_info->restore_type != RESTORE_TO_FILE || restore_info->backup_level == CUBRID_RESTORE_ALL_LEVELS))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
     if (restore_info->restore_type == RESTORE_TO_FILE)
     {
         if (IS_NULL (restore_info->backup_file_path))
@@ -391,6 +419,15 @@ int check_restore_info (CUBRID_RESTORE_INFO* restore_info)
             goto error;
         }
     }
+    /* RESTORE_TO_DB: directory of the fifo, NULL is backup_home */
+    else if (IS_NOT_NULL (restore_info->backup_file_path))
+    {
+        if (IS_FAILURE (validate_dir (restore_info->backup_file_path)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
 
     if (IS_NULL (restore_info->db_name))
     {
@@ -412,9 +449,9 @@ error:
 }
 
 static
-int set_restore_info (CUBRID_RESTORE_INFO* restore_info, RESTORE_HANDLE* restore_handle)
+int set_restore_info (CUBRID_RESTORE_INFO* restore_info, bool is_resumable, RESTORE_HANDLE* restore_handle)
 {
-    if (IS_FAILURE (check_restore_info (restore_info)))
+    if (IS_FAILURE (check_restore_info (restore_info, is_resumable)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
@@ -424,7 +461,16 @@ int set_restore_info (CUBRID_RESTORE_INFO* restore_info, RESTORE_HANDLE* restore
 
     restore_handle->backup_level = restore_info->backup_level;
 
-    snprintf (restore_handle->backup_file_path, PATH_MAX, "%s", restore_info->backup_file_path);
+    restore_handle->is_resumable = is_resumable;
+
+    if (IS_NULL (restore_info->backup_file_path))
+    {
+        snprintf (restore_handle->backup_file_path, PATH_MAX, "%s", backup_mgr->backup_home);
+    }
+    else
+    {
+        snprintf (restore_handle->backup_file_path, PATH_MAX, "%s", restore_info->backup_file_path);
+    }
 
     snprintf (restore_handle->db_name, MAX_DB_NAME_LEN + 1, "%s", restore_info->db_name);
 
@@ -439,6 +485,8 @@ static
 int make_fifo (HANDLE_TYPE handle_type, void* handle)
 {
     BACKUP_HANDLE* backup_handle;
+    RESTORE_HANDLE* restore_handle;
+    char fifo_dir[PATH_MAX];
 
     if (handle_type == BACKUP_HANDLE_TYPE)
     {
@@ -470,6 +518,51 @@ int make_fifo (HANDLE_TYPE handle_type, void* handle)
             goto error;
         }
     }
+    else if (handle_type == RESTORE_HANDLE_TYPE)
+    {
+        restore_handle = (RESTORE_HANDLE *)handle;
+
+        /*
+         * ex) <backup_file_path>/demodb_restore.Xa1b2c/demodb_bk0v000, cubrid restoredb 의 -B 로 넘긴다.
+         * backup_file_path 에 있는 같은 이름의 backup file 을 지우지 않도록 session 마다 새 directory 에 만든다.
+         */
+        snprintf (fifo_dir, PATH_MAX, "%s/%s_restore.XXXXXX", restore_handle->backup_file_path,
+                                                              restore_handle->db_name);
+
+        snprintf (restore_handle->fifo_path, PATH_MAX, "%s/%s_bk%dv000", fifo_dir,
+                                                                         restore_handle->db_name,
+                                                                         restore_handle->backup_level);
+
+        if (IS_FAILURE (check_path_length_limit (restore_handle->fifo_path)))
+        {
+            restore_handle->fifo_path[0] = '\0';
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        if (IS_NULL (mkdtemp (fifo_dir)))
+        {
+            restore_handle->fifo_path[0] = '\0';
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        snprintf (restore_handle->fifo_path, PATH_MAX, "%s/%s_bk%dv000", fifo_dir,
+                                                                         restore_handle->db_name,
+                                                                         restore_handle->backup_level);
+
+        if (IS_FAILURE (mkfifo (restore_handle->fifo_path, S_IRUSR|S_IWUSR)))
+        {
+            rmdir (fifo_dir);
+
+            restore_handle->fifo_path[0] = '\0';
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
     else
     {
         PRINT_LOG_ERR (ERR_INFO);
@@ -483,6 +576,34 @@ error:
     return FAILURE;
 }
 
+static
+int set_pipe_size (BACKUP_HANDLE* backup_handle)
+{
+    int retval = SUCCESS;
+    int pipe_size;
+
+    if (backup_handle->pipe_size > 0)
+    {
+        // 커널이 허용하는 크기(/proc/sys/fs/pipe-max-size)를 넘으면 실패하는데,
+        // 이 경우에도 기본 크기의 pipe 로 백업은 계속 진행한다.
+        if (-1 == fcntl (backup_handle->fifo_fd, F_SETPIPE_SZ, backup_handle->pipe_size))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            retval = FAILURE;
+        }
+    }
+
+    pipe_size = fcntl (backup_handle->fifo_fd, F_GETPIPE_SZ);
+
+    PRINT_LOG_INFO ("set_pipe_size (), fifo_path => %s, requested => %d, granted => %d\n",
+                    backup_handle->fifo_path,
+                    backup_handle->pipe_size,
+                    pipe_size);
+
+    return retval;
+}
+
 static
 int open_fifo (HANDLE_TYPE handle_type, void* handle)
 {
@@ -505,6 +626,8 @@ int open_fifo (HANDLE_TYPE handle_type, void* handle)
             PRINT_LOG_ERR (ERR_INFO);
             goto error;
         }
+
+        set_pipe_size (backup_handle);
     }
     else
     {
@@ -523,6 +646,7 @@ static
 int remove_fifo (HANDLE_TYPE handle_type, void* handle)
 {
     BACKUP_HANDLE* backup_handle;
+    RESTORE_HANDLE* restore_handle;
 
     if (handle_type == BACKUP_HANDLE_TYPE)
     {
@@ -536,6 +660,31 @@ int remove_fifo (HANDLE_TYPE handle_type, void* handle)
 
         backup_handle->fifo_path[0] = '\0';
     }
+    else if (handle_type == RESTORE_HANDLE_TYPE)
+    {
+        restore_handle = (RESTORE_HANDLE *)handle;
+
+        if (IS_FAILURE (unlink (restore_handle->fifo_path)))
+        {
+            restore_handle->fifo_path[0] = '\0';
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        // make_fifo () 가 만든 directory 도 지운다.
+        *strrchr (restore_handle->fifo_path, '/') = '\0';
+
+        if (IS_FAILURE (rmdir (restore_handle->fifo_path)))
+        {
+            restore_handle->fifo_path[0] = '\0';
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        restore_handle->fifo_path[0] = '\0';
+    }
     else
     {
         PRINT_LOG_ERR (ERR_INFO);
@@ -553,6 +702,7 @@ static
 int close_fifo (HANDLE_TYPE handle_type, void* handle)
 {
     BACKUP_HANDLE* backup_handle;
+    RESTORE_HANDLE* restore_handle;
 
     if (handle_type == BACKUP_HANDLE_TYPE)
     {
@@ -565,6 +715,18 @@ int close_fifo (HANDLE_TYPE handle_type, void* handle)
 
         backup_handle->fifo_fd = -1;
     }
+    else if (handle_type == RESTORE_HANDLE_TYPE)
+    {
+        restore_handle = (RESTORE_HANDLE *)handle;
+
+        /* cubrid restoredb 는 EOF 를 backup 의 끝으로 본다. */
+        if (restore_handle->fifo_fd != -1)
+        {
+            close (restore_handle->fifo_fd);
+        }
+
+        restore_handle->fifo_fd = -1;
+    }
     else
     {
         PRINT_LOG_ERR (ERR_INFO);
@@ -584,8 +746,75 @@ error:
     return FAILURE;
 }
 
+/*
+ * fork () 는 library 를 사용하는 process 의 page table 을 복사하므로
+ * RSS 가 큰 process 에서는 수십 msec 이 걸리고 메모리가 일시적으로 두 배로 commit 된다.
+ * posix_spawn () 은 (glibc) CLONE_VM | CLONE_VFORK 로 child 를 생성하므로 복사 비용이 없다.
+ */
+static
+int spawn_process (char* path, char** argv, posix_spawn_file_actions_t* file_actions, pid_t* pid)
+{
+    posix_spawnattr_t spawn_attr;
+    sigset_t sig_mask;
+    sigset_t sig_default;
+
+    int state = 0;
+
+    if (IS_FAILURE (posix_spawnattr_init (&spawn_attr)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    sigemptyset (&sig_mask);
+    sigemptyset (&sig_default);
+    sigaddset (&sig_default, SIGPIPE);
+
+    // for kill process group
+    // backup process 가 자신이 leader 인 process group 을 갖도록 하여 (pgroup 0)
+    // cancel 시 library 를 사용하는 process 나 다른 backup 에 영향을 주지 않게 한다.
+    // signal mask 는 write 중에 SIGPIPE 를 막는 thread 의 것을 물려받지 않도록 비운다.
+    // SIGPIPE 만 default 로 되돌려 읽는 쪽이 닫힌 fifo 에 쓰는 cubrid 가 종료되도록 하고,
+    // 그 밖의 signal 은 그대로 물려준다. (ex. nohup 의 SIGHUP SIG_IGN)
+    if (IS_FAILURE (posix_spawnattr_setflags (&spawn_attr, POSIX_SPAWN_SETPGROUP |
+                                                           POSIX_SPAWN_SETSIGMASK |
+                                                           POSIX_SPAWN_SETSIGDEF |
+                                                           POSIX_SPAWN_USEVFORK)) ||
+        IS_FAILURE (posix_spawnattr_setpgroup (&spawn_attr, 0)) ||
+        IS_FAILURE (posix_spawnattr_setsigmask (&spawn_attr, &sig_mask)) ||
+        IS_FAILURE (posix_spawnattr_setsigdefault (&spawn_attr, &sig_default)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (posix_spawn (pid, path, file_actions, &spawn_attr, argv, environ)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    posix_spawnattr_destroy (&spawn_attr);
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            posix_spawnattr_destroy (&spawn_attr);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
 static
-int execute_cubrid_backupdb (BACKUP_HANDLE* backup_handle)
+int execute_cubrid_backupdb (BACKUP_HANDLE* backup_handle, pid_t* backup_pid)
 {
     BACKUP_OPTION* backup_opt;
 
@@ -720,7 +949,7 @@ int execute_cubrid_backupdb (BACKUP_HANDLE* backup_handle)
     //printf ("%s\n", backup_cmd);
 #endif
 
-    if (-1 == execv (cub_admin, (char * const *)argv))
+    if (IS_FAILURE (spawn_process (cub_admin, argv, NULL, backup_pid)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
@@ -733,227 +962,208 @@ error:
     return FAILURE;
 }
 
+/*
+ * cubrid backupdb 를 실행하고 process manager 에 감시를 맡긴다.
+ *
+ * 별도의 process 를 생성하는 이유는 사용자 레벨에서의 hang 방지 때문이다.
+ * - libcubridsa.so 를 링크하여 thread 에서 백업을 수행하면 cubrid_backup_finalize () 호출 시
+ *   boot_shutdown_client_at_exit () (atexit () 등록 됨) 함수에서 coredump 가 발생한다.
+ *   (백업 thread 와 cubrid_backup_finalize () 를 호출한 thread 의 id 가 다르기 때문)
+ */
 static
-void kill_process_group (pid_t pgid)
-{
-    struct sigaction act, old_act;
-
-    act.sa_handler = SIG_IGN;
-    sigemptyset (&act.sa_mask);
-    act.sa_flags   = 0;
-
-    //printf ("pid: %d, pgid: %d\n", getpid (), getpgid (getpid ()));
-
-    // backup-api library 자체는 죽으면 안돼기 때문에
-    sigaction (SIGTERM, &act, &old_act);
-
-    killpg (pgid, SIGTERM);
-
-    sigaction (SIGTERM, &old_act, NULL);
-
-#if 0
-    // FAILURE: Has been interrupted. 를 cubrid_utility.log 에 남기기 위해
-    // SIGINT 를 사용하려고 했으나, cub_admin 에서 SIG_INT 핸들러를 등록해두어서
-    // cub_admin 이 바로 죽지 않는다.
-    // FAILURE: Has been interrupted. 로그를 남긴다는 것 자체가 정상 종료(예외처리) 했다는 것이다.
-    sigaction (SIGINT, &act, &old_act);
-
-    killpg (pgid, SIGINT);
-
-    sigaction (SIGINT, &old_act, NULL);
-#endif
-}
-
-void zombie_handler()
-{
-    /*
-    int status;
-    int spid;
-    spid = wait(&status);
-    printf("자식프로세스 wait 성공 \n");
-    printf("================================\n");
-    printf("PID         : %d\n", spid);
-    printf("Exit Value  : %d\n", WEXITSTATUS(status));
-    printf("Exit Stat   : %d\n", WIFEXITED(status));
-    */
-}
-
-static
-int check_backup_process_status (BACKUP_HANDLE* backup_handle, pid_t backup_pid)
+int launch_backup_process (BACKUP_HANDLE* backup_handle)
 {
-    sigset_t sa_mask;
-    struct timespec wait_timeout;
+    struct timespec start_time;
+    struct timespec end_time;
+    pid_t backup_pid;
 
-    int status;
+    clock_gettime (CLOCK_MONOTONIC, &start_time);
 
-    sigemptyset (&sa_mask);
-    sigaddset (&sa_mask, SIGCHLD);
- 
-    wait_timeout.tv_sec  = 1;
-    wait_timeout.tv_nsec = 0;
-
-    // SIGCHLD에 대한 빈 핸들러를 등록한 이유는
-    // 아래 sigtimedwait () 에서 cubrid의 종료를 감지하지 못하기 때문이다.
-    // 따라서 cubrid 유틸은 <defunct> 상태가 되며,
-    // cubrid_backup_read () 에서는 백업 쓰레드가 종료되었다는 사실을 모르게 된다.
-    // 테스트 용으로 zombie_handler 를 등록했는데,
-    // 원하는대로 cubrid 유틸 종료시 SIGCHLD를 던저주며, 이를 catch할 수 있게 됐다.
-    // 이유는 아직 못찾았다.
-    signal(SIGCHLD, (void *)zombie_handler);
-
-    // 현재 cub_admin 을 직접 fork 하는 방식을 사용 중인데 log를 cubrid 유틸에서 남기기 때문에
-    // 기술 본부에서 참조하는 cubrid_utility.log 로그에 백업 관련 기록이 남지 않는다.
-    // 따러서 cubrid 를 fork 하는 방식으로 바꾸고 kill 시 다 죽이자 후손까지
-    while (true)   
-    {
-        //sigemptyset (&sa_mask);
-        //sigaddset (&sa_mask, SIGCHLD);
-        //int ret;
-
-        //ret = sigtimedwait (&sa_mask, NULL, &wait_timeout);
-        //if (-1 == ret)
-        if (-1 == sigtimedwait (&sa_mask, NULL, &wait_timeout))
-        {
-            /* timeout */
-            if (errno == EAGAIN && backup_handle->is_cancel != true)
-            {
-                continue;
-            }
+    if (IS_FAILURE (execute_cubrid_backupdb (backup_handle, &backup_pid)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-            //printf ("must hit here 4\n");
-            kill_process_group (getpgid (backup_pid));
+    clock_gettime (CLOCK_MONOTONIC, &end_time);
 
-            break;
-        }
-        else
-        {
-            //printf ("must hit here 1, ret val => %d, SIGCHLD => %d\n", ret, SIGCHLD);
-            if (-1 == waitpid (backup_pid, &status, 0))
-            {
-                PRINT_LOG_ERR (ERR_INFO);
-                goto error;
-            }
+    backup_handle->backup_stat.launch_usecs = (end_time.tv_sec - start_time.tv_sec) * 1000000LL +
+                                              (end_time.tv_nsec - start_time.tv_nsec) / 1000;
+    backup_handle->backup_stat.launch_time = start_time;
 
-            /* backup process(cubrid) return or exit () */
-            if (WIFEXITED (status))
-            {
-                /*
-                 * backup process return value:
-                 * 0 - backup success
-                 * 1 - backup failure
-                 */
-                if (WEXITSTATUS(status))
-                {
-                    PRINT_LOG_ERR (ERR_INFO);
-                    goto error;
-                }
-            }
-            /* backup process is dead by signal */
-            else if (WIFSIGNALED(status)) /* signal */
-            {
-                PRINT_LOG_ERR (ERR_INFO);
-                goto error;
-            }
-            /* backup process is stopped */
-            else if (WIFSTOPPED(status))
-            {
-                kill_process_group (getpgid (backup_pid));
+    backup_handle->backup_pid = backup_pid;
 
-                PRINT_LOG_ERR (ERR_INFO);
-                goto error;
-            }
+    if (IS_FAILURE (supervise_backup_process (backup_handle)))
+    {
+        killpg (backup_pid, SIGKILL);
+        waitpid (backup_pid, NULL, 0);
 
-            break;
-        }
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
     }
 
-    //printf ("must hit here 2\n");
     return SUCCESS;
 
 error:
 
-    waitpid (backup_pid, NULL, WNOHANG);
-
     return FAILURE;
 }
 
-static
-void* execute_backup (void* handle)
+int begin_backup (CUBRID_BACKUP_INFO* backup_info, void** handle)
 {
     BACKUP_HANDLE* backup_handle;
-    pid_t backup_pid;
 
-    if (IS_NULL (handle))
+    int state = 0;
+
+    if (IS_NULL (backup_info) || IS_NULL (handle))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    // for kill process group
-    setpgid (getpid (), getpid ());
-
-    backup_handle = (BACKUP_HANDLE *)handle;
+    if (IS_FAILURE (alloc_handle (BACKUP_HANDLE_TYPE, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-    backup_pid = fork ();
+    state = 1;
 
-    if (backup_pid == -1)
+    if (IS_FAILURE (set_backup_info (backup_info, backup_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
-    else if (backup_pid == 0) /* child process */
+
+    /* the fifo is named after db_name, so one database can be backed up by only one handle at a time */
+    if (IS_FAILURE (register_handle (BACKUP_HANDLE_TYPE, backup_handle)))
     {
-        if (IS_FAILURE (execute_cubrid_backupdb (backup_handle)))
-        {
-            PRINT_LOG_ERR (ERR_INFO);
-            goto error;
-        }
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
     }
-    else /* parent process */
+
+    if (IS_FAILURE (open_fifo (BACKUP_HANDLE_TYPE, backup_handle)))
     {
-        if (IS_FAILURE (check_backup_process_status (backup_handle, backup_pid)))
-        {
-            PRINT_LOG_ERR (ERR_INFO);
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 2;
+
+    if (IS_FAILURE (launch_backup_process (backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 3;
+
+    if (backup_mgr->default_backup_option.read_ahead_size > 0 || backup_mgr->default_backup_option.spill_size > 0)
+    {
+        if (IS_FAILURE (start_read_ahead (backup_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
             goto error;
         }
     }
 
-    // thread -> backup process
-    // - thread 종료되었다고 ... backup_process 종료된건 아니다.
-    // - 이 thread --fork--> backup process 구조는 검증 후 개선이 필요할 듯 하다.
-    //   - 이 구조를 취한건 cubrid backup 유틸리티에서 자신을 실행한 thread id
-    //     를 검증하는 부분이 있기 때문이다.
-    //   - thread 로 백업 수행(libcubridsa.so 링크) 후 백업 수행 (백업 마다 thread 생성 or 한 쓰레드)
-    //     cubrid_backup_finalize () 호출 시 boot_shutdown_client_at_exit () (atexit () 등록 됨)
-    //     함수에서 coredump 발생
-    //     이유는 백업은 thread 생성해서 수행되고, cubrid_backup_finalize () 호출은 main thread가
-    //     호출하기 때문에 두 thread id가 달라서 발생된다고 분석된 상태.
-    //     별도의 thread나 process를 생성해야 하는 이유는 사용자 레벨에서의 hang 방지.
-    //printf ("must hit here 3\n");
-    set_thread_state (BACKUP_HANDLE_TYPE, backup_handle, THREAD_STATE_EXIT);
+    state = 4;
+
+    if (IS_FAILURE (transit_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_BEGINNING, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_unlock (&backup_handle->backup_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    *handle = get_handle_id (BACKUP_HANDLE_TYPE, backup_handle);
 
-    pthread_exit (NULL);
+    return SUCCESS;
 
 error:
 
-    set_thread_state (BACKUP_HANDLE_TYPE, backup_handle, THREAD_STATE_EXIT_WITH_ERROR);
+    switch (state)
+    {
+        case 4:
+        case 3:
+            cancel_backup_process (backup_handle);
+            wait_backup_process (backup_handle);
+            stop_read_ahead (backup_handle);
+        case 2:
+            close_fifo (BACKUP_HANDLE_TYPE, backup_handle);
+        case 1:
+            free_handle (BACKUP_HANDLE_TYPE, backup_handle);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+static
+void print_backup_stat (BACKUP_HANDLE* backup_handle)
+{
+    BACKUP_STAT* backup_stat;
+    double syscalls_per_gib = 0.0;
+    unsigned long long bytes_per_read = 0;
+
+    backup_stat = &backup_handle->backup_stat;
+
+    if (backup_stat->read_bytes != 0)
+    {
+        syscalls_per_gib = backup_stat->read_syscall_count / (backup_stat->read_bytes / GIGABYTE);
+    }
+
+    if (backup_stat->read_call_count != 0)
+    {
+        bytes_per_read = backup_stat->read_bytes / backup_stat->read_call_count;
+    }
 
-    pthread_exit (NULL);
+    PRINT_LOG_INFO ("backup stat, db_name => %s, read_bytes => %llu, read_syscall_count => %llu, syscalls_per_gib => %.1f, bytes_per_read => %llu, read_timeout_count => %llu, ring_full_count => %llu, spill_high_water => %llu, spill_bytes => %llu, launch_usecs => %lld, process_msecs => %lld, reader_msecs => %lld\n",
+                    backup_handle->db_name,
+                    backup_stat->read_bytes,
+                    backup_stat->read_syscall_count,
+                    syscalls_per_gib,
+                    bytes_per_read,
+                    backup_stat->read_timeout_count,
+                    backup_stat->ring_full_count,
+                    backup_stat->spill_high_water,
+                    backup_stat->spill_bytes,
+                    backup_stat->launch_usecs,
+                    backup_stat->process_msecs,
+                    backup_stat->reader_msecs);
 }
 
-int begin_backup (CUBRID_BACKUP_INFO* backup_info, void** handle)
+int end_backup (void* backup_handle_id)
 {
     BACKUP_HANDLE* backup_handle;
+    int retval = SUCCESS;
 
     int state = 0;
 
-    if (IS_NULL (backup_info) || IS_NULL (handle))
+    if (IS_NULL (backup_handle_id))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (alloc_handle (BACKUP_HANDLE_TYPE, (void **)&backup_handle)))
+    // mutex 잡기전에 handle validation을 먼저 수행하도록 변경한다.
+    // 사유는 쓰레기 (NULL 아닌) 값을 handle로 전달할 경우
+    // 1. hang
+    // 2. seg fault
+    // 발생할 수 있다.
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&backup_handle->backup_mutex)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
@@ -961,37 +1171,61 @@ int begin_backup (CUBRID_BACKUP_INFO* backup_info, void** handle)
 
     state = 1;
 
-    if (IS_FAILURE (set_backup_info (backup_info, backup_handle)))
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (open_fifo (BACKUP_HANDLE_TYPE, backup_handle)))
+    if (IS_FAILURE (transit_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE, HANDLE_STATE_ENDING)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    state = 2;
+    if (get_process_state (backup_handle) == PROCESS_STATE_RUNNING)
+    {
+        cancel_backup_process (backup_handle);
+        wait_backup_process (backup_handle);
+    }
+
+    stop_async_io (&backup_handle->async_io);
 
-    set_thread_state (BACKUP_HANDLE_TYPE, backup_handle, THREAD_STATE_RUNNING);
+    stop_read_ahead (backup_handle);
 
-    if (IS_FAILURE (pthread_create (&backup_handle->backup_thread, NULL, execute_backup, (void *)backup_handle)))
+    if (backup_handle->poll_fd != -1)
     {
-        set_thread_state (BACKUP_HANDLE_TYPE, backup_handle, THREAD_STATE_EXIT_WITH_ERROR);
+        close (backup_handle->poll_fd);
+
+        backup_handle->poll_fd = -1;
+    }
 
+    // fifo 를 지우지 못했더라도 handle 은 정리하고 FAILURE 를 return 한다.
+    if (IS_FAILURE (close_fifo (BACKUP_HANDLE_TYPE, backup_handle)))
+    {
         PRINT_LOG_ERR (ERR_INFO);
-        goto error;
+
+        retval = FAILURE;
     }
 
-    if (IS_FAILURE (pthread_mutex_unlock (&backup_handle->backup_mutex)))
+    print_backup_stat (backup_handle);
+
+    /* free_handle () unlocks backup_mutex */
+    if (IS_FAILURE (free_handle (BACKUP_HANDLE_TYPE, backup_handle)))
     {
+        // ENDING 에 남으면 slot 을 다시 쓸 수 없으므로 되돌려서 cubrid_backup_end () 를 다시 호출할 수 있게 한다.
+        transit_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_ENDING, HANDLE_STATE_IN_SERVICE);
+
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    *(BACKUP_HANDLE **)handle = backup_handle;
+    if (IS_FAILURE (retval))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        return FAILURE;
+    }
 
     return SUCCESS;
 
@@ -999,12 +1233,8 @@ error:
 
     switch (state)
     {
-        case 2:
-            backup_handle->is_cancel = true;
-            pthread_join (backup_handle->backup_thread, NULL);
-            close_fifo (BACKUP_HANDLE_TYPE, backup_handle);
         case 1:
-            free_handle (BACKUP_HANDLE_TYPE, backup_handle);
+            pthread_mutex_unlock (&backup_handle->backup_mutex);
         default:
             break;
     }
@@ -1012,64 +1242,84 @@ error:
     return FAILURE;
 }
 
-int end_backup (BACKUP_HANDLE* backup_handle)
+/*
+ * backup_mutex 를 잡지 않는다.
+ * (cubrid_backup_read () 가 backup_mutex 를 잡고 fifo 를 기다리는 중에도 바로 cancel 할 수 있어야 한다.)
+ */
+int cancel_backup (void* backup_handle_id)
 {
-    int state = 0;
+    BACKUP_HANDLE* backup_handle;
 
-    if (IS_NULL (backup_handle))
+    if (IS_NULL (backup_handle_id))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    // mutex 잡기전에 handle validation을 먼저 수행하도록 변경한다.
-    // 사유는 쓰레기 (NULL 아닌) 값을 handle로 전달할 경우
-    // 1. hang
-    // 2. seg fault
-    // 발생할 수 있다.
-    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle)))
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (pthread_mutex_lock (&backup_handle->backup_mutex)))
+    if (IS_FAILURE (check_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    state = 1;
+    cancel_backup_process (backup_handle);
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
 
-    if (backup_handle->backup_thread_state == THREAD_STATE_RUNNING)
+int set_read_lowat (void* backup_handle_id, unsigned int read_lowat)
+{
+    BACKUP_HANDLE* backup_handle;
+
+    int state = 0;
+
+    if (IS_NULL (backup_handle_id))
     {
-        backup_handle->is_cancel = true;
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-        if (IS_FAILURE (pthread_join (backup_handle->backup_thread, NULL)))
-        {
-            PRINT_LOG_ERR (ERR_INFO);
-            goto error;
-        }
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
     }
 
-    if (IS_FAILURE (close_fifo (BACKUP_HANDLE_TYPE, backup_handle)))
+    if (IS_FAILURE (pthread_mutex_lock (&backup_handle->backup_mutex)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (free_handle (BACKUP_HANDLE_TYPE, backup_handle)))
+    state = 1;
+
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (pthread_mutex_unlock (&backup_handle->backup_mutex)))
+    if (IS_FAILURE (check_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
+    backup_handle->read_lowat = read_lowat;
+
+    pthread_mutex_unlock (&backup_handle->backup_mutex);
+
     return SUCCESS;
 
 error:
@@ -1085,160 +1335,3422 @@ error:
     return FAILURE;
 }
 
-static
-int read_fifo (int fifo_fd, int io_size, char* buffer, int* read_len)
+/* cubrid_backup_set_pipe_size (): 0 이면 cubrid_backup.conf 의 pipe_size 로 되돌린다. */
+int set_backup_pipe_size (void* backup_handle_id, int pipe_size)
 {
-    int retval;
-    int read_size;
+    BACKUP_HANDLE* backup_handle;
 
-    fd_set read_fds;
+    int state = 0;
 
-    FD_ZERO (&read_fds);
-    FD_SET (fifo_fd, &read_fds);
+    if (IS_NULL (backup_handle_id) || pipe_size < 0)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-    struct timeval wait_timeout;
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-    wait_timeout.tv_sec  = 2;
-    wait_timeout.tv_usec = 0;
+    if (IS_FAILURE (pthread_mutex_lock (&backup_handle->backup_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-    retval = select (fifo_fd + 1, &read_fds, NULL, NULL, &wait_timeout);
+    state = 1;
 
-    if (retval == -1)
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
-    else if (retval == 0)
+
+    if (IS_FAILURE (check_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE)))
     {
-        *read_len = 0;
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
     }
-    else
-    {
-        if (FD_ISSET (fifo_fd, &read_fds))
-        {
-            read_size = read (fifo_fd, buffer, io_size);
 
-            if (read_size == -1)
-            {
-                PRINT_LOG_ERR (ERR_INFO);
-                goto error;
-            }
+    backup_handle->pipe_size = IS_ZERO (pipe_size) ? backup_mgr->default_backup_option.pipe_size : pipe_size;
 
-            *read_len = read_size;
-        }
-        else
-        {
-            PRINT_LOG_ERR (ERR_INFO);
-            goto error;
-        }
+    if (IS_FAILURE (set_pipe_size (backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
     }
 
+    pthread_mutex_unlock (&backup_handle->backup_mutex);
+
     return SUCCESS;
 
 error:
 
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&backup_handle->backup_mutex);
+        default:
+            break;
+    }
+
     return FAILURE;
 }
 
+#define MAX_POLL_EVENT_COUNT (2)
+
 static
-int read_data (BACKUP_HANDLE* backup_handle, char* buffer, unsigned int buffer_size, unsigned int* data_len, bool* is_backup_end)
+int add_poll_event (int poll_fd, int fd, uint32_t events)
 {
-    int io_size = 0;
-    int read_len = 0;
-    int total_read_len = 0;
-    int read_count = 0;
-    int i;
+    struct epoll_event event;
 
-    if (backup_handle->fifo_fd == -1)
+    event.events  = events;
+    event.data.fd = fd;
+
+    if (-1 == epoll_ctl (poll_fd, EPOLL_CTL_ADD, fd, &event))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    io_size = backup_mgr->io_size;
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * cubrid_backup_read_nb () 를 다시 호출할 때가 되면 readable 이 되는 epoll fd 를 만든다.
+ * - read-ahead: ring 에 data 가 들어오거나 prefetch thread 가 끝나면 (data_event_fd)
+ * - fifo: fifo 에 data 가 들어오거나 writer 가 닫았을 때 (edge-triggered),
+ *         또는 backup process 가 회수되었을 때 (exit_fd)
+ *
+ * writer 가 fifo 를 닫은 뒤 backup process 가 회수될 때까지 POLLHUP 이 계속 보이지 않도록
+ * fifo 는 edge-triggered 로 등록하고, 빈 read 를 return 하기 전에 rearm_backup_pollfd () 로 event 를 거둔다.
+ */
+int get_backup_pollfd (void* backup_handle_id, int* poll_fd)
+{
+    BACKUP_HANDLE* backup_handle;
 
-    read_count = buffer_size / io_size;
+    int state = 0;
 
-    for (i = 0; i < read_count; i ++)
+    if (IS_NULL (backup_handle_id) || IS_NULL (poll_fd))
     {
-        if (backup_handle->backup_thread_state == THREAD_STATE_EXIT_WITH_ERROR)
-        {
-            PRINT_LOG_ERR (ERR_INFO);
-            goto error;
-        }
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&backup_handle->backup_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-        if (IS_FAILURE (read_fifo (backup_handle->fifo_fd, io_size, buffer + total_read_len, &read_len)))
+    state = 1;
+
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (backup_handle->poll_fd == -1)
+    {
+        backup_handle->poll_fd = epoll_create1 (EPOLL_CLOEXEC);
+
+        if (backup_handle->poll_fd == -1)
         {
             PRINT_LOG_ERR (ERR_INFO);
             goto error;
         }
 
-        total_read_len += read_len;
+        state = 2;
 
-        if (total_read_len == 0)
+        if (IS_NOT_NULL (backup_handle->read_ahead))
         {
-            if (backup_handle->backup_thread_state == THREAD_STATE_EXIT)
+            if (IS_FAILURE (add_poll_event (backup_handle->poll_fd, backup_handle->read_ahead->data_event_fd, EPOLLIN)))
             {
-                *is_backup_end = true;
-
-                break;
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
+            }
+        }
+        else
+        {
+            if (IS_FAILURE (add_poll_event (backup_handle->poll_fd, backup_handle->fifo_fd, EPOLLIN | EPOLLET)) ||
+                IS_FAILURE (add_poll_event (backup_handle->poll_fd, backup_handle->exit_fd, EPOLLIN)))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
             }
         }
     }
 
-    io_size = buffer_size % io_size;
+    *poll_fd = backup_handle->poll_fd;
+
+    pthread_mutex_unlock (&backup_handle->backup_mutex);
+
+    return SUCCESS;
+
+error:
 
-    if (io_size != 0 && *is_backup_end != true) // refactoring
+    switch (state)
     {
-        if (backup_handle->backup_thread_state == THREAD_STATE_EXIT_WITH_ERROR)
-        {
-            PRINT_LOG_ERR (ERR_INFO);
-            goto error;
-        }
+        case 2:
+            close (backup_handle->poll_fd);
+            backup_handle->poll_fd = -1;
+        case 1:
+            pthread_mutex_unlock (&backup_handle->backup_mutex);
+        default:
+            break;
+    }
 
-        if (IS_FAILURE (read_fifo (backup_handle->fifo_fd, io_size, buffer + total_read_len, &read_len)))
-        {
-            PRINT_LOG_ERR (ERR_INFO);
-            goto error;
-        }
+    return FAILURE;
+}
+
+/*
+ * 이미 받은 wakeup 을 비운다. 호출한 쪽은 이후에 fifo (ring) 를 한 번 더 확인해야 한다.
+ * (그 사이에 들어온 data 는 다시 poll_fd 를 깨운다.)
+ */
+static
+void rearm_backup_pollfd (BACKUP_HANDLE* backup_handle)
+{
+    struct epoll_event events[MAX_POLL_EVENT_COUNT];
+
+    if (IS_NOT_NULL (backup_handle->read_ahead))
+    {
+        rearm_read_ahead (backup_handle->read_ahead);
+    }
+    else
+    {
+        /* edge-triggered fifo event 는 epoll_wait () 로 거둬야 poll_fd 가 readable 상태에서 벗어난다. */
+        epoll_wait (backup_handle->poll_fd, events, MAX_POLL_EVENT_COUNT, 0);
+    }
+}
+
+static
+int wait_fifo (int fifo_fd, int timeout_msecs, bool* is_ready, bool* is_hangup)
+{
+    struct pollfd poll_fd;
+    int retval;
+
+    poll_fd.fd      = fifo_fd;
+    poll_fd.events  = POLLIN;
+    poll_fd.revents = 0;
+
+    *is_ready  = false;
+    *is_hangup = false;
+
+    retval = poll (&poll_fd, 1, timeout_msecs);
+
+    if (retval == -1)
+    {
+        if (errno == EINTR)
+        {
+            goto end;
+        }
+
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+    else if (retval == 0)
+    {
+        /* timeout */
+        goto end;
+    }
+
+    if (poll_fd.revents & (POLLERR | POLLNVAL))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // writer 가 fifo 를 닫으면 POLLHUP 만 올라온다.
+    // 이 경우에도 read () 로 EOF 를 확인해야 하므로 ready 로 본다.
+    if (poll_fd.revents & POLLHUP)
+    {
+        *is_hangup = (poll_fd.revents & POLLIN) ? false : true;
+    }
+
+    *is_ready = true;
+
+end:
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * out_fd 에 쓸 수 있을 때까지 기다린다.
+ * out_fd 는 blocking descriptor 이어야 하지만, splice () 는 fifo 쪽 때문에 non-blocking 이므로
+ * out_fd 가 가득 찬 경우에도 EAGAIN 을 return 한다.
+ */
+static
+int wait_out_fd (int out_fd)
+{
+    struct pollfd poll_fd;
+
+    poll_fd.fd      = out_fd;
+    poll_fd.events  = POLLOUT;
+    poll_fd.revents = 0;
+
+    while (-1 == poll (&poll_fd, 1, -1))
+    {
+        if (errno != EINTR)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            return FAILURE;
+        }
+    }
+
+    /* POLLERR, POLLHUP: 다음 write 가 실패하면서 알려준다. */
+    return SUCCESS;
+}
+
+/* out_fd 가 지금 쓸 수 있는 상태인지 확인한다. */
+static
+bool is_out_fd_writable (int out_fd)
+{
+    struct pollfd poll_fd;
+
+    poll_fd.fd      = out_fd;
+    poll_fd.events  = POLLOUT;
+    poll_fd.revents = 0;
+
+    return (poll (&poll_fd, 1, 0) == 1) ? true : false;
+}
+
+static
+ssize_t transfer_fifo (BACKUP_HANDLE* backup_handle, READ_TARGET* read_target, unsigned int offset, unsigned int request_len, bool* is_drained)
+{
+    char bounce_buffer[SPLICE_BOUNCE_BUFFER_SIZE];
+    ssize_t read_size;
+    ssize_t write_size;
+    ssize_t written = 0;
+
+    *is_drained = false;
+
+    if (IS_NOT_NULL (read_target->buffer))
+    {
+        read_size = read (backup_handle->fifo_fd, read_target->buffer + offset, request_len);
+
+        backup_handle->backup_stat.read_syscall_count ++;
+
+        /* short read: the fifo has been drained */
+        if (read_size > 0 && read_size < request_len)
+        {
+            *is_drained = true;
+        }
+
+        return read_size;
+    }
+
+    while (read_target->use_splice == true)
+    {
+        read_size = splice (backup_handle->fifo_fd, NULL, read_target->out_fd, NULL, request_len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+        backup_handle->backup_stat.read_syscall_count ++;
+
+        // EAGAIN 은 fifo 가 비었거나 out_fd 가 가득 찬 경우이다.
+        // out_fd 때문이면 fifo 를 poll () 해도 바로 깨어나므로 out_fd 를 기다린 뒤 다시 splice () 한다.
+        if (read_size == -1 && errno == EAGAIN && is_out_fd_writable (read_target->out_fd) == false)
+        {
+            if (IS_FAILURE (wait_out_fd (read_target->out_fd)))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                return TRANSFER_OUT_FD_ERROR;
+            }
+
+            continue;
+        }
+
+        if (read_size != -1 || errno != EINVAL)
+        {
+            return read_size;
+        }
+
+        // out_fd 가 splice () 를 지원하지 않는 경우 (O_APPEND 로 열린 파일 등)
+        // 이번 호출의 나머지는 read () / write () 로 처리한다.
+        read_target->use_splice = false;
+    }
+
+    if (request_len > SPLICE_BOUNCE_BUFFER_SIZE)
+    {
+        request_len = SPLICE_BOUNCE_BUFFER_SIZE;
+    }
+
+    read_size = read (backup_handle->fifo_fd, bounce_buffer, request_len);
+
+    backup_handle->backup_stat.read_syscall_count ++;
+
+    if (read_size <= 0)
+    {
+        return read_size;
+    }
+
+    if (read_size < request_len)
+    {
+        *is_drained = true;
+    }
+
+    // fifo 에서 읽은 data 는 되돌릴 수 없으므로 모두 쓰거나 실패한다.
+    while (written < read_size)
+    {
+        write_size = write (read_target->out_fd, bounce_buffer + written, read_size - written);
+
+        if (write_size == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if (errno == EAGAIN && IS_SUCCESS (wait_out_fd (read_target->out_fd)))
+            {
+                continue;
+            }
+
+            PRINT_LOG_ERR (ERR_INFO);
+            return TRANSFER_OUT_FD_ERROR;
+        }
+
+        written += write_size;
+    }
+
+    return read_size;
+}
+
+/*
+ * transfer_fifo () 와 같지만 prefetch thread 가 채운 ring 에서 읽는다.
+ * 0: backup 의 끝, -1 (EAGAIN): ring 이 비어 있음
+ */
+static
+ssize_t transfer_ring (BACKUP_HANDLE* backup_handle, READ_TARGET* read_target, unsigned int offset, unsigned int request_len, bool* is_drained)
+{
+    READ_AHEAD* read_ahead = backup_handle->read_ahead;
+    READ_AHEAD_STATE read_ahead_state;
+    unsigned int total_len = 0;
+    unsigned int len;
+    ssize_t write_size;
+    char* data;
+
+    *is_drained = false;
+
+    while (total_len < request_len)
+    {
+        // ring 이 비어 있을 때 EOF 를 믿으려면 state 를 먼저 읽어야 한다.
+        // (prefetch thread 는 마지막 data 를 넣은 뒤에 EOF 로 바꾼다.)
+        read_ahead_state = get_read_ahead_state (read_ahead);
+
+        len = peek_read_ahead (read_ahead, &data);
+
+        if (IS_ZERO (len))
+        {
+            *is_drained = true;
+
+            if (total_len != 0)
+            {
+                break;
+            }
+
+            if (read_ahead_state == READ_AHEAD_STATE_EOF)
+            {
+                return 0;
+            }
+
+            errno = (read_ahead_state == READ_AHEAD_STATE_ERROR) ? EIO : EAGAIN;
+
+            return -1;
+        }
+
+        if (len > request_len - total_len)
+        {
+            len = request_len - total_len;
+        }
+
+        if (IS_NOT_NULL (read_target->buffer))
+        {
+            memcpy (read_target->buffer + offset + total_len, data, len);
+        }
+        else
+        {
+            write_size = write (read_target->out_fd, data, len);
+
+            if (write_size == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                if (errno == EAGAIN && IS_SUCCESS (wait_out_fd (read_target->out_fd)))
+                {
+                    continue;
+                }
+
+                PRINT_LOG_ERR (ERR_INFO);
+                return TRANSFER_OUT_FD_ERROR;
+            }
+
+            len = write_size;
+        }
+
+        release_read_ahead (read_ahead, len);
+
+        total_len += len;
+    }
+
+    return total_len;
+}
+
+static
+int get_remain_msecs (struct timespec* deadline)
+{
+    struct timespec now;
+    long long remain_msecs;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    remain_msecs = (deadline->tv_sec - now.tv_sec) * 1000LL + (deadline->tv_nsec - now.tv_nsec) / 1000000;
+
+    return (remain_msecs > 0) ? (int)remain_msecs : 0;
+}
+
+static
+void record_reader_end (BACKUP_HANDLE* backup_handle)
+{
+    BACKUP_STAT* backup_stat = &backup_handle->backup_stat;
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    backup_stat->reader_msecs = (now.tv_sec - backup_stat->launch_time.tv_sec) * 1000LL +
+                                (now.tv_nsec - backup_stat->launch_time.tv_nsec) / 1000000;
+}
+
+/*
+ * timeout_msecs 는 한 번의 호출 전체에 대한 제한이다.
+ * (poll () 을 여러 번 하더라도 deadline 을 넘기지 않는다.)
+ * -1 이면 deadline 없이 min_fill 만큼 채워질 때까지 기다린다.
+ *
+ * min_fill 만큼 읽기 전에는 fifo 가 비어도 return 하지 않는다.
+ * (deadline, writer 의 close (), backup 종료 시에는 min_fill 보다 적을 수 있다.)
+ */
+static
+int transfer_data (BACKUP_HANDLE* backup_handle, READ_TARGET* read_target, unsigned int buffer_size, unsigned int min_fill, int timeout_msecs, unsigned int* data_len, bool* is_backup_end)
+{
+    struct timespec deadline;
+    unsigned int total_read_len = 0;
+    ssize_t read_size;
+    int remain_msecs;
+
+    bool is_drained;
+    bool is_ready;
+    bool is_hangup = false;
+    bool is_rearmed = false;
+
+    if (backup_handle->fifo_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (timeout_msecs != -1)
+    {
+        clock_gettime (CLOCK_MONOTONIC, &deadline);
+
+        deadline.tv_sec  += timeout_msecs / 1000;
+        deadline.tv_nsec += (timeout_msecs % 1000) * 1000000L;
+
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec  += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    // fifo 에 쌓여 있는 만큼 buffer 의 남은 공간으로 바로 읽어들이고,
+    // 읽을 데이터가 하나도 없을 때만 poll () 로 readable 상태를 기다린다.
+    while (total_read_len < buffer_size)
+    {
+        if (get_process_state (backup_handle) == PROCESS_STATE_EXIT_WITH_ERROR)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        if (IS_NOT_NULL (backup_handle->read_ahead))
+        {
+            read_size = transfer_ring (backup_handle, read_target, total_read_len, buffer_size - total_read_len, &is_drained);
+        }
+        else
+        {
+            read_size = transfer_fifo (backup_handle, read_target, total_read_len, buffer_size - total_read_len, &is_drained);
+        }
+
+        if (read_size > 0)
+        {
+            total_read_len += read_size;
+
+            if (is_drained == true && total_read_len >= min_fill)
+            {
+                break;
+            }
+
+            continue;
+        }
+        else if (read_size == TRANSFER_OUT_FD_ERROR)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+        else if (read_size == 0)
+        {
+            /* no writer on the fifo */
+            if (total_read_len != 0 || (is_hangup == true && min_fill == 1))
+            {
+                break;
+            }
+
+            if (get_process_state (backup_handle) == PROCESS_STATE_EXIT)
+            {
+                *is_backup_end = true;
+
+                record_reader_end (backup_handle);
+
+                break;
+            }
+
+            // read_lowat 이 설정되어 있으면 빈 buffer 를 return 하지 않는다.
+            // writer 가 fifo 를 닫은 뒤에는 poll () 이 바로 return 하므로
+            // backup process 가 회수되거나 다시 fifo 를 열 때까지 잠시 기다린다.
+            if (is_hangup == true)
+            {
+                wait_backup_process_timeout (backup_handle, PROCESS_POLL_INTERVAL_MSECS);
+
+                is_hangup = false;
+
+                continue;
+            }
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno != EAGAIN)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+        else if (total_read_len >= min_fill)
+        {
+            break;
+        }
+
+        if (timeout_msecs != -1)
+        {
+            remain_msecs = get_remain_msecs (&deadline);
+
+            if (IS_ZERO (remain_msecs))
+            {
+                // 빈 read 를 return 하기 전에 poll_fd 에 남아 있는 wakeup 을 비우고 한 번 더 확인해야
+                // cubrid_backup_get_pollfd () 가 읽을 것이 없는데도 계속 깨어나는 일이 없다.
+                if (backup_handle->poll_fd != -1 && is_rearmed == false)
+                {
+                    rearm_backup_pollfd (backup_handle);
+
+                    is_rearmed = true;
+
+                    continue;
+                }
+
+                if (timeout_msecs > 0)
+                {
+                    backup_handle->backup_stat.read_timeout_count ++;
+                }
+
+                break;
+            }
+        }
+        else
+        {
+            /* backup process 의 종료를 확인하기 위해 주기적으로 깨어난다. */
+            remain_msecs = backup_mgr->default_backup_option.read_timeout_msecs;
+
+            if (IS_ZERO (remain_msecs))
+            {
+                remain_msecs = DEFAULT_READ_TIMEOUT_MSECS;
+            }
+        }
+
+        if (IS_NOT_NULL (backup_handle->read_ahead))
+        {
+            if (IS_FAILURE (wait_read_ahead (backup_handle->read_ahead, remain_msecs, &is_ready)))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
+            }
+        }
+        else
+        {
+            if (IS_FAILURE (wait_fifo (backup_handle->fifo_fd, remain_msecs, &is_ready, &is_hangup)))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
+            }
+
+            backup_handle->backup_stat.read_syscall_count ++;
+        }
+
+        if (is_ready == false)
+        {
+            // timeout 이 아닌 EINTR 이면 남은 시간 동안 다시 기다린다.
+            continue;
+        }
+    }
+
+    backup_handle->backup_stat.read_bytes += total_read_len;
+
+    if (total_read_len != 0)
+    {
+        backup_handle->backup_stat.read_call_count ++;
+    }
+
+    *data_len = total_read_len;
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * is_fill_buffer: read_lowat 과 관계없이 buffer 를 가득 채울 때까지 (deadline 없이) 기다린다.
+ */
+static
+int transfer_backup_data (void* backup_handle_id, READ_TARGET* read_target, unsigned int buffer_size, bool is_fill_buffer, int timeout_msecs, unsigned int* data_len, bool* is_backup_end)
+{
+    BACKUP_HANDLE* backup_handle;
+    unsigned int min_fill;
+
+    int state = 0;
+
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&backup_handle->backup_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // cubrid_backup_submit_read () 를 쓰기 시작하면 fifo 는 worker thread 만 읽는다.
+    if (IS_NOT_NULL (backup_handle->async_io))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // read_lowat 이 설정되어 있으면 deadline 이 주어진 경우에만 덜 채워진 buffer 를 return 한다.
+    if (is_fill_buffer == true)
+    {
+        min_fill = buffer_size;
+    }
+    else if (IS_ZERO (backup_handle->read_lowat))
+    {
+        min_fill = 1;
+
+        // read_timeout_msecs=0 은 deadline 없이 data 가 올 때까지 기다린다. (기다리지 않으면 호출하는 쪽이 busy-spin 한다.)
+        if (timeout_msecs == -1 && backup_mgr->default_backup_option.read_timeout_msecs > 0)
+        {
+            timeout_msecs = backup_mgr->default_backup_option.read_timeout_msecs;
+        }
+    }
+    else
+    {
+        min_fill = (backup_handle->read_lowat < buffer_size) ? backup_handle->read_lowat : buffer_size;
+    }
+
+    if (IS_FAILURE (transfer_data (backup_handle, read_target, buffer_size, min_fill, timeout_msecs, data_len, is_backup_end)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_unlock (&backup_handle->backup_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&backup_handle->backup_mutex);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+int read_backup_data (void* backup_handle_id, void* buffer, unsigned int buffer_size, unsigned int* data_len, int timeout_msecs, bool* is_backup_end)
+{
+    READ_TARGET read_target;
+
+    if (IS_NULL (backup_handle_id) || IS_NULL (buffer) || IS_ZERO (buffer_size) || IS_NULL (data_len) || timeout_msecs < -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    read_target.buffer     = buffer;
+    read_target.out_fd     = -1;
+    read_target.use_splice = false;
+
+    if (IS_FAILURE (transfer_backup_data (backup_handle_id, &read_target, buffer_size, false, timeout_msecs, data_len, is_backup_end)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int read_backup_data_to_fd (void* backup_handle_id, int out_fd, unsigned int max_bytes, unsigned int* moved, bool* is_backup_end)
+{
+    READ_TARGET read_target;
+
+    if (IS_NULL (backup_handle_id) || out_fd < 0 || IS_ZERO (max_bytes) || IS_NULL (moved))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    read_target.buffer     = NULL;
+    read_target.out_fd     = out_fd;
+    read_target.use_splice = true;
+
+    if (IS_FAILURE (transfer_backup_data (backup_handle_id, &read_target, max_bytes, false, -1, moved, is_backup_end)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * cubrid_backup_run ()
+ *
+ * fill thread 가 buffer 를 채우는 동안 호출한 thread 는 이미 채워진 buffer 로 sink_cb 를 호출한다.
+ * buffer 는 채워진 순서대로 sink_cb 에 전달되며, sink_cb 가 늦으면 빈 buffer 가 생길 때까지 fill thread 가 기다린다.
+ *
+ * filled_count - drained_count: sink_cb 에 전달되기를 기다리는 buffer 수 (<= buffer_count)
+ */
+typedef struct backup_run BACKUP_RUN;
+struct backup_run
+{
+    void* backup_handle_id;
+
+    pthread_t fill_thread;
+    pthread_mutex_t run_mutex;
+    pthread_cond_t run_cond;
+
+    char* buffers;
+    unsigned int buffer_size;
+    unsigned int buffer_count;
+    unsigned int* data_lens;
+
+    unsigned long long filled_count;  /* protected by run_mutex */
+    unsigned long long drained_count; /* protected by run_mutex */
+
+    bool is_fill_end;   /* the last buffer has been filled, protected by run_mutex */
+    bool is_fill_error; /* protected by run_mutex */
+    bool is_stop;       /* sink_cb failed, protected by run_mutex */
+};
+
+static
+void* fill_backup_buffers (void* arg)
+{
+    BACKUP_RUN* backup_run = (BACKUP_RUN *)arg;
+    READ_TARGET read_target;
+    unsigned long long slot;
+    unsigned int data_len;
+    bool is_backup_end = false;
+    int retval;
+
+    read_target.out_fd     = -1;
+    read_target.use_splice = false;
+
+    while (is_backup_end == false)
+    {
+        pthread_mutex_lock (&backup_run->run_mutex);
+
+        while (backup_run->filled_count - backup_run->drained_count == backup_run->buffer_count && backup_run->is_stop == false)
+        {
+            pthread_cond_wait (&backup_run->run_cond, &backup_run->run_mutex);
+        }
+
+        slot = backup_run->filled_count % backup_run->buffer_count;
+
+        if (backup_run->is_stop == true)
+        {
+            pthread_mutex_unlock (&backup_run->run_mutex);
+            break;
+        }
+
+        pthread_mutex_unlock (&backup_run->run_mutex);
+
+        read_target.buffer = backup_run->buffers + slot * backup_run->buffer_size;
+
+        retval = transfer_backup_data (backup_run->backup_handle_id, &read_target, backup_run->buffer_size, true, -1, &data_len, &is_backup_end);
+
+        pthread_mutex_lock (&backup_run->run_mutex);
+
+        if (IS_FAILURE (retval))
+        {
+            backup_run->is_fill_error = true;
+        }
+        else
+        {
+            backup_run->data_lens[slot] = data_len;
+            backup_run->filled_count ++;
+        }
+
+        if (IS_FAILURE (retval) || is_backup_end == true)
+        {
+            backup_run->is_fill_end = true;
+        }
+
+        pthread_cond_broadcast (&backup_run->run_cond);
+        pthread_mutex_unlock (&backup_run->run_mutex);
+
+        if (IS_FAILURE (retval))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static
+int drain_backup_buffers (BACKUP_RUN* backup_run, CUBRID_BACKUP_SINK sink_cb, void* ctx)
+{
+    unsigned long long slot;
+    unsigned int data_len;
+
+    while (1)
+    {
+        pthread_mutex_lock (&backup_run->run_mutex);
+
+        while (backup_run->filled_count == backup_run->drained_count && backup_run->is_fill_end == false)
+        {
+            pthread_cond_wait (&backup_run->run_cond, &backup_run->run_mutex);
+        }
+
+        if (backup_run->filled_count == backup_run->drained_count)
+        {
+            /* is_fill_end */
+            pthread_mutex_unlock (&backup_run->run_mutex);
+            break;
+        }
+
+        slot = backup_run->drained_count % backup_run->buffer_count;
+        data_len = backup_run->data_lens[slot];
+
+        pthread_mutex_unlock (&backup_run->run_mutex);
+
+        if (data_len != 0 && sink_cb (ctx, backup_run->buffers + slot * backup_run->buffer_size, data_len) != 0)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        pthread_mutex_lock (&backup_run->run_mutex);
+
+        backup_run->drained_count ++;
+
+        pthread_cond_broadcast (&backup_run->run_cond);
+        pthread_mutex_unlock (&backup_run->run_mutex);
+    }
+
+    if (backup_run->is_fill_error == true)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int run_backup (void* backup_handle_id, CUBRID_BACKUP_SINK sink_cb, void* ctx, unsigned int buffer_size, unsigned int buffer_count)
+{
+    BACKUP_RUN backup_run;
+    BACKUP_HANDLE* backup_handle;
+
+    int state = 0;
+
+    if (IS_NULL (backup_handle_id) || IS_NULL (sink_cb) || IS_ZERO (buffer_size) ||
+        buffer_count < 2 || buffer_count > MAX_BACKUP_RUN_BUFFER_COUNT)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    backup_run.backup_handle_id = backup_handle_id;
+    backup_run.buffer_size      = buffer_size;
+    backup_run.buffer_count     = buffer_count;
+    backup_run.filled_count     = 0;
+    backup_run.drained_count    = 0;
+    backup_run.is_fill_end      = false;
+    backup_run.is_fill_error    = false;
+    backup_run.is_stop          = false;
+
+    backup_run.buffers = (char *)malloc ((size_t)buffer_size * buffer_count);
+
+    if (IS_NULL (backup_run.buffers))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    backup_run.data_lens = (unsigned int *)malloc (sizeof (unsigned int) * buffer_count);
+
+    if (IS_NULL (backup_run.data_lens))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 2;
+
+    if (IS_FAILURE (pthread_mutex_init (&backup_run.run_mutex, NULL)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 3;
+
+    if (IS_FAILURE (pthread_cond_init (&backup_run.run_cond, NULL)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 4;
+
+    if (IS_FAILURE (pthread_create (&backup_run.fill_thread, NULL, fill_backup_buffers, &backup_run)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 5;
+
+    if (IS_FAILURE (drain_backup_buffers (&backup_run, sink_cb, ctx)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    pthread_join (backup_run.fill_thread, NULL);
+
+    pthread_cond_destroy (&backup_run.run_cond);
+    pthread_mutex_destroy (&backup_run.run_mutex);
+
+    free (backup_run.data_lens);
+    free (backup_run.buffers);
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 5:
+            // sink_cb 가 실패하면 backup 을 멈춘다.
+            // fill thread 가 fifo 를 기다리고 있더라도 backup process 가 종료되면 바로 깨어난다.
+            pthread_mutex_lock (&backup_run.run_mutex);
+            backup_run.is_stop = true;
+            pthread_cond_broadcast (&backup_run.run_cond);
+            pthread_mutex_unlock (&backup_run.run_mutex);
+
+            cancel_backup (backup_handle_id);
+
+            pthread_join (backup_run.fill_thread, NULL);
+        case 4:
+            pthread_cond_destroy (&backup_run.run_cond);
+        case 3:
+            pthread_mutex_destroy (&backup_run.run_mutex);
+        case 2:
+            free (backup_run.data_lens);
+        case 1:
+            free (backup_run.buffers);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/* cubrid_backup_submit_read () 로 들어온 buffer 하나를 채운다. (worker thread, backup_mutex 없이) */
+static
+int read_async_backup_data (void* handle, ASYNC_IO_ENTRY* entry)
+{
+    BACKUP_HANDLE* backup_handle = (BACKUP_HANDLE *)handle;
+    READ_TARGET read_target;
+    unsigned int read_lowat;
+    unsigned int min_fill;
+    bool is_backup_end = false;
+
+    read_target.buffer     = entry->buffer;
+    read_target.out_fd     = -1;
+    read_target.use_splice = false;
+
+    read_lowat = backup_handle->read_lowat;
+
+    if (IS_ZERO (read_lowat))
+    {
+        min_fill = 1;
+    }
+    else
+    {
+        min_fill = (read_lowat < entry->buffer_size) ? read_lowat : entry->buffer_size;
+    }
+
+    if (IS_FAILURE (transfer_data (backup_handle, &read_target, entry->buffer_size, min_fill, -1, &entry->data_len, &is_backup_end)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        return FAILURE;
+    }
+
+    return (is_backup_end == true) ? SUCCESS : SUCCESS_FRAGMENTED;
+}
+
+/*
+ * worker thread 는 handle 마다 처음 submit 할 때 만든다.
+ * 이후의 cubrid_backup_read () 등과 섞이지 않도록 backup_mutex 를 잡고 만든다.
+ */
+static
+int start_backup_async_io (void* backup_handle_id, ASYNC_IO** async_io)
+{
+    BACKUP_HANDLE* backup_handle;
+
+    int state = 0;
+
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&backup_handle->backup_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_NULL (backup_handle->async_io))
+    {
+        if (IS_FAILURE (start_async_io (backup_handle, read_async_backup_data, async_io)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        __atomic_store_n (&backup_handle->async_io, *async_io, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        *async_io = backup_handle->async_io;
+    }
+
+    pthread_mutex_unlock (&backup_handle->backup_mutex);
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&backup_handle->backup_mutex);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/* returns SUCCESS_WOULDBLOCK if the submission queue is full */
+int submit_backup_read (void* backup_handle_id, void* buffer, unsigned int buffer_size, void* user_data)
+{
+    BACKUP_HANDLE* backup_handle;
+    ASYNC_IO* async_io;
+    ASYNC_IO_ENTRY entry;
+
+    if (IS_NULL (backup_handle_id) || IS_NULL (buffer) || IS_ZERO (buffer_size))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    async_io = __atomic_load_n (&backup_handle->async_io, __ATOMIC_ACQUIRE);
+
+    if (IS_NULL (async_io))
+    {
+        if (IS_FAILURE (start_backup_async_io (backup_handle_id, &async_io)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    entry.buffer       = buffer;
+    entry.buffer_size  = buffer_size;
+    entry.data_len     = 0;
+    entry.backup_level = backup_handle->backup_level;
+    entry.result       = FAILURE;
+    entry.user_data    = user_data;
+
+    return submit_async_io (async_io, &entry);
+
+error:
+
+    return FAILURE;
+}
+
+int reap_backup_data (void* backup_handle_id, CUBRID_IO_COMPLETION* completions, unsigned int max_count, int timeout_msecs, unsigned int* count)
+{
+    BACKUP_HANDLE* backup_handle;
+    ASYNC_IO* async_io;
+
+    if (IS_NULL (backup_handle_id) || IS_NULL (completions) || IS_ZERO (max_count) || IS_NULL (count) || timeout_msecs < -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle_id, (void **)&backup_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (BACKUP_HANDLE_TYPE, backup_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    async_io = __atomic_load_n (&backup_handle->async_io, __ATOMIC_ACQUIRE);
+
+    if (IS_NULL (async_io))
+    {
+        /* nothing has been submitted */
+        *count = 0;
+
+        return SUCCESS;
+    }
+
+    if (IS_FAILURE (reap_async_io (async_io, completions, max_count, timeout_msecs, count)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+static
+int open_restore_file (RESTORE_HANDLE* restore_handle)
+{
+    char restore_file[PATH_MAX];
+    int open_flags = O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC;
+
+    /* ex) demodb_bk0v000 */
+    snprintf (restore_file, PATH_MAX, "%s/%s_bk%dv000", restore_handle->backup_file_path,
+                                                        restore_handle->db_name,
+                                                        restore_handle->backup_level);
+
+    if (IS_FAILURE (check_path_length_limit (restore_file)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+#if 0
+    // 파일이 존재하면 따로 검사하지 말고, overwrite 해버리자
+    if (IS_SUCCESS (access (restore_file, F_OK)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+#endif
+
+    // checkpoint 가 있으면 이어서 쓰도록 restore file 을 비우지 않는다.
+    if (IS_NOT_ZERO (restore_handle->resume_offset))
+    {
+        open_flags &= ~O_TRUNC;
+    }
+
+    // direct_io_size 가 설정되면 page cache 를 거치지 않도록 O_DIRECT 로 연다.
+    if (backup_mgr->default_restore_option.direct_io_size > 0)
+    {
+        restore_handle->restore_fd = open (restore_file, open_flags | O_DIRECT, S_IRUSR | S_IWUSR);
+
+        if (restore_handle->restore_fd != -1)
+        {
+            return SUCCESS;
+        }
+
+        /* ex) tmpfs */
+        if (errno != EINVAL)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        PRINT_LOG_INFO ("O_DIRECT is not supported, restore_file => %s, restore writes go through the page cache\n", restore_file);
+    }
+
+    restore_handle->restore_fd = open (restore_file, open_flags, S_IRUSR | S_IWUSR);
+
+    if (restore_handle->restore_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+static
+int close_restore_file (RESTORE_HANDLE* restore_handle)
+{
+    if (restore_handle->restore_fd != -1)
+    {
+        close (restore_handle->restore_fd);
+
+        restore_handle->restore_fd = -1;
+
+        restore_handle->backup_file_path[0] = '\0';
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * expected_size 만큼 미리 할당해서 restore file 이 연속된 extent 에 쓰이도록 한다.
+ * FALLOC_FL_KEEP_SIZE 이므로 file 크기는 write 한 만큼만 늘어나고,
+ * 덜 쓴 경우 남은 할당은 cubrid_restore_end () 의 trim_restore_file () 이 돌려준다.
+ */
+static
+int preallocate_restore_file (RESTORE_HANDLE* restore_handle)
+{
+    if (IS_ZERO (restore_handle->expected_size))
+    {
+        return SUCCESS;
+    }
+
+    if (-1 == fallocate (restore_handle->restore_fd, FALLOC_FL_KEEP_SIZE, 0, restore_handle->expected_size))
+    {
+        // 공간이 모자라면 restore 도중이 아니라 지금 실패한다.
+        if (errno == ENOSPC || errno == EFBIG)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            PRINT_LOG_INFO ("preallocate_restore_file (), expected_size => %lld, errno => %d\n", restore_handle->expected_size, errno);
+            goto error;
+        }
+
+        /* ex) EOPNOTSUPP, the file grows one write at a time */
+        PRINT_LOG_INFO ("fallocate is not supported, expected_size => %lld, errno => %d\n", restore_handle->expected_size, errno);
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/* 미리 할당했지만 쓰지 않은 부분을 돌려준다. */
+static
+int trim_restore_file (RESTORE_HANDLE* restore_handle)
+{
+    if (restore_handle->expected_size <= restore_handle->write_offset)
+    {
+        return SUCCESS;
+    }
+
+    if (-1 == ftruncate (restore_handle->restore_fd, restore_handle->write_offset))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/* ex) demodb_bk0v000.ckpt, "<db_name> <backup_level> <expected_size> <checkpoint_offset>" */
+static
+int get_checkpoint_file (RESTORE_HANDLE* restore_handle, char* checkpoint_file, char* temp_file)
+{
+    snprintf (checkpoint_file, PATH_MAX, "%s/%s_bk%dv000.ckpt", restore_handle->backup_file_path,
+                                                                restore_handle->db_name,
+                                                                restore_handle->backup_level);
+
+    snprintf (temp_file, PATH_MAX, "%s.tmp", checkpoint_file);
+
+    if (IS_FAILURE (check_path_length_limit (temp_file)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * 이전 session 이 남긴 checkpoint 를 읽어 resume_offset 에 담는다.
+ * 없거나 이 session 과 맞지 않는 checkpoint 는 무시하고 처음부터 쓴다. (resume_offset 0)
+ */
+static
+int read_checkpoint (RESTORE_HANDLE* restore_handle)
+{
+    char checkpoint_file[PATH_MAX];
+    char temp_file[PATH_MAX];
+    char checkpoint[MAX_DB_NAME_LEN + 64];
+    char db_name[MAX_DB_NAME_LEN + 64];
+    int backup_level;
+    long long expected_size;
+    long long checkpoint_offset;
+    ssize_t read_size;
+    int checkpoint_fd;
+
+    restore_handle->resume_offset = 0;
+
+    if (IS_FAILURE (get_checkpoint_file (restore_handle, checkpoint_file, temp_file)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    checkpoint_fd = open (checkpoint_file, O_RDONLY | O_CLOEXEC);
+
+    if (checkpoint_fd == -1)
+    {
+        if (errno != ENOENT)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        return SUCCESS;
+    }
+
+    read_size = read (checkpoint_fd, checkpoint, sizeof (checkpoint) - 1);
+
+    close (checkpoint_fd);
+
+    if (read_size == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    checkpoint[read_size] = '\0';
+
+    if (4 != sscanf (checkpoint, "%s %d %lld %lld", db_name, &backup_level, &expected_size, &checkpoint_offset) ||
+        0 != strcmp (db_name, restore_handle->db_name) ||
+        backup_level != restore_handle->backup_level ||
+        expected_size < 0 ||
+        checkpoint_offset < 0)
+    {
+        PRINT_LOG_INFO ("checkpoint does not match the restore session, checkpoint_file => %s, restore starts over\n", checkpoint_file);
+
+        return SUCCESS;
+    }
+
+    /* O_DIRECT 로 이어서 쓸 수 있도록 block 경계로 내린다. */
+    restore_handle->resume_offset = checkpoint_offset & ~((long long)DIRECT_IO_ALIGN - 1);
+
+    // 이전 session 이 cubrid_restore_set_expected_size () 로 준 크기를 이어받는다.
+    restore_handle->expected_size = expected_size;
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * checkpoint_offset 까지 durable 하다는 것을 기록한다. (restore_fd 는 이미 fdatasync () 한 상태)
+ * 임시 file 에 쓰고 rename () 하므로 도중에 죽어도 이전 checkpoint 나 새 checkpoint 중 하나가 남는다.
+ */
+static
+int write_checkpoint (RESTORE_HANDLE* restore_handle, long long checkpoint_offset)
+{
+    char checkpoint_file[PATH_MAX];
+    char temp_file[PATH_MAX];
+    char checkpoint[MAX_DB_NAME_LEN + 64];
+    int checkpoint_len;
+    int checkpoint_fd;
+    int dir_fd;
+
+    int state = 0;
+
+    if (IS_FAILURE (get_checkpoint_file (restore_handle, checkpoint_file, temp_file)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    checkpoint_len = snprintf (checkpoint, sizeof (checkpoint), "%s %d %lld %lld\n", restore_handle->db_name,
+                                                                                    restore_handle->backup_level,
+                                                                                    restore_handle->expected_size,
+                                                                                    checkpoint_offset);
+
+    checkpoint_fd = open (temp_file, O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, S_IRUSR | S_IWUSR);
+
+    if (checkpoint_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    if (checkpoint_len != write (checkpoint_fd, checkpoint, checkpoint_len))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (-1 == fdatasync (checkpoint_fd))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    close (checkpoint_fd);
+
+    state = 2;
+
+    if (-1 == rename (temp_file, checkpoint_file))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // rename () 과 처음 만든 restore file 이 directory 에 남도록 한다.
+    dir_fd = open (restore_handle->backup_file_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (dir_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (-1 == fsync (dir_fd))
+    {
+        close (dir_fd);
+
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    close (dir_fd);
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            close (checkpoint_fd);
+        case 2:
+            unlink (temp_file);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+static
+int remove_checkpoint (RESTORE_HANDLE* restore_handle)
+{
+    char checkpoint_file[PATH_MAX];
+    char temp_file[PATH_MAX];
+
+    if (IS_FAILURE (get_checkpoint_file (restore_handle, checkpoint_file, temp_file)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (-1 == unlink (checkpoint_file) && errno != ENOENT)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * checkpoint 까지만 남기고 그 뒤는 잘라낸다. (durable 하지 않았던 부분)
+ * restore file 이 checkpoint 보다 짧으면 checkpoint 를 믿을 수 없으므로 처음부터 쓴다.
+ */
+static
+int resume_restore_file (RESTORE_HANDLE* restore_handle)
+{
+    struct stat restore_stat;
+
+    if (-1 == fstat (restore_handle->restore_fd, &restore_stat))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (restore_stat.st_size < restore_handle->resume_offset)
+    {
+        PRINT_LOG_INFO ("restore file is shorter than the checkpoint, resume_offset => %lld, file_size => %lld, restore starts over\n",
+                        restore_handle->resume_offset, (long long)restore_stat.st_size);
+
+        restore_handle->resume_offset = 0;
+    }
+
+    if (-1 == ftruncate (restore_handle->restore_fd, restore_handle->resume_offset))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // restore writer 가 없으면 write () 는 file offset 에 쓴다.
+    if (-1 == lseek (restore_handle->restore_fd, restore_handle->resume_offset, SEEK_SET))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    restore_handle->write_offset      = restore_handle->resume_offset;
+    restore_handle->writeback_offset  = restore_handle->resume_offset;
+    restore_handle->checkpoint_offset = restore_handle->resume_offset;
+
+    if (IS_NOT_ZERO (restore_handle->resume_offset))
+    {
+        PRINT_LOG_INFO ("restore is resumed, db_name => %s, backup_level => %d, resume_offset => %lld\n",
+                        restore_handle->db_name, restore_handle->backup_level, restore_handle->resume_offset);
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * resumable session 은 checkpoint_size 만큼 쓸 때마다 그때까지 쓴 data 를 fdatasync () 하고 checkpoint 를 남긴다.
+ * restore writer 가 모으는 중인 data 는 아직 쓰이지 않았으므로 그 앞까지만 기록한다.
+ */
+static
+int control_checkpoint (RESTORE_HANDLE* restore_handle)
+{
+    long long synced_offset = restore_handle->write_offset;
+
+    if (restore_handle->is_resumable == false ||
+        restore_handle->write_offset - restore_handle->checkpoint_offset < backup_mgr->default_restore_option.checkpoint_size)
+    {
+        return SUCCESS;
+    }
+
+    if (IS_NOT_NULL (restore_handle->restore_writer))
+    {
+        if (IS_FAILURE (sync_restore_writer (restore_handle->restore_writer, &synced_offset)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    if (synced_offset <= restore_handle->checkpoint_offset)
+    {
+        return SUCCESS;
+    }
+
+    if (-1 == fdatasync (restore_handle->restore_fd))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (write_checkpoint (restore_handle, synced_offset)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    restore_handle->checkpoint_offset = synced_offset;
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * cubrid_restore_end () 에서 restore writer 를 멈춘 뒤에 호출한다.
+ * expected_size 를 다 쓰지 못하고 끝난 session 은 다음 session 이 이어서 쓸 수 있도록
+ * 마지막까지 쓴 data 로 checkpoint 를 남기고, 다 쓴 session 은 checkpoint 를 지운다.
+ */
+static
+int close_checkpoint (RESTORE_HANDLE* restore_handle)
+{
+    if (IS_ZERO (restore_handle->expected_size) || restore_handle->write_offset >= restore_handle->expected_size)
+    {
+        return remove_checkpoint (restore_handle);
+    }
+
+    if (-1 == fdatasync (restore_handle->restore_fd))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (write_checkpoint (restore_handle, restore_handle->write_offset)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    PRINT_LOG_INFO ("restore is not complete, db_name => %s, backup_level => %d, checkpoint_offset => %lld, expected_size => %lld\n",
+                    restore_handle->db_name,
+                    restore_handle->backup_level,
+                    restore_handle->write_offset,
+                    restore_handle->expected_size);
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * cubrid_restore_pwrite () 가 쓴 [start, end) 를 range map 에 더한다. (restore_mutex 를 잡은 상태에서)
+ * 겹치거나 맞닿은 구간은 하나로 합치므로, 순서 없이 써도 빈틈이 없으면 결국 구간 하나가 남는다.
+ */
+static
+int insert_restore_range (RESTORE_HANDLE* restore_handle, long long start, long long end)
+{
+    RESTORE_RANGE* ranges;
+    int capacity;
+    int low = 0;
+    int high = restore_handle->range_count;
+    int mid;
+    int i;
+
+    /* first range that ends at or after start */
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+
+        if (restore_handle->ranges[mid].end < start)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    /* ranges that overlap or touch [start, end) */
+    for (i = low; i < restore_handle->range_count && restore_handle->ranges[i].start <= end; i ++)
+    {
+        if (restore_handle->ranges[i].start < start)
+        {
+            start = restore_handle->ranges[i].start;
+        }
+
+        if (restore_handle->ranges[i].end > end)
+        {
+            end = restore_handle->ranges[i].end;
+        }
+    }
+
+    if (i == low)
+    {
+        if (restore_handle->range_count == restore_handle->range_capacity)
+        {
+            capacity = IS_ZERO (restore_handle->range_capacity) ? DEFAULT_RESTORE_RANGE_COUNT : restore_handle->range_capacity * 2;
+
+            ranges = (RESTORE_RANGE *)realloc (restore_handle->ranges, capacity * sizeof (RESTORE_RANGE));
+
+            if (IS_NULL (ranges))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
+            }
+
+            restore_handle->ranges         = ranges;
+            restore_handle->range_capacity = capacity;
+        }
+
+        memmove (&restore_handle->ranges[low + 1], &restore_handle->ranges[low],
+                 (restore_handle->range_count - low) * sizeof (RESTORE_RANGE));
+
+        restore_handle->range_count ++;
+    }
+    else
+    {
+        memmove (&restore_handle->ranges[low + 1], &restore_handle->ranges[i],
+                 (restore_handle->range_count - i) * sizeof (RESTORE_RANGE));
+
+        restore_handle->range_count -= i - low - 1;
+    }
+
+    restore_handle->ranges[low].start = start;
+    restore_handle->ranges[low].end   = end;
+
+    /* trim_restore_file () */
+    if (end > restore_handle->write_offset)
+    {
+        restore_handle->write_offset = end;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/* cubrid_restore_pwrite () 로 쓴 restore file 이 0 부터 (expected_size 까지) 빈틈없이 채워졌는지 확인한다. */
+static
+int check_restore_ranges (RESTORE_HANDLE* restore_handle)
+{
+    long long gap_start;
+    long long gap_end;
+
+    if (restore_handle->is_positional == false)
+    {
+        return SUCCESS;
+    }
+
+    if (IS_ZERO (restore_handle->range_count))
+    {
+        gap_start = 0;
+        gap_end   = restore_handle->expected_size;
+    }
+    else if (IS_NOT_ZERO (restore_handle->ranges[0].start))
+    {
+        gap_start = 0;
+        gap_end   = restore_handle->ranges[0].start;
+    }
+    else if (restore_handle->range_count > 1)
+    {
+        gap_start = restore_handle->ranges[0].end;
+        gap_end   = restore_handle->ranges[1].start;
+    }
+    else
+    {
+        gap_start = restore_handle->ranges[0].end;
+        gap_end   = restore_handle->expected_size;
+    }
+
+    if (gap_start < gap_end)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        PRINT_LOG_INFO ("restore file has a gap, db_name => %s, backup_level => %d, gap => [%lld, %lld), range_count => %d\n",
+                        restore_handle->db_name,
+                        restore_handle->backup_level,
+                        gap_start,
+                        gap_end,
+                        restore_handle->range_count);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+static
+int execute_restore_to_file (RESTORE_HANDLE* restore_handle)
+{
+    if (restore_handle->is_resumable == true)
+    {
+        if (IS_FAILURE (read_checkpoint (restore_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    // restore file 을 새로 쓰므로 이전 session 의 checkpoint 는 더 이상 맞지 않는다.
+    else if (IS_FAILURE (remove_checkpoint (restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (open_restore_file (restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_NOT_ZERO (restore_handle->resume_offset))
+    {
+        if (IS_FAILURE (resume_restore_file (restore_handle)))
+        {
+            close_restore_file (restore_handle);
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    if (IS_FAILURE (preallocate_restore_file (restore_handle)))
+    {
+        close_restore_file (restore_handle);
+
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // O_DIRECT 는 aligned buffer 가 필요하므로 restore writer 가 data 를 모아서 쓴다.
+    if (backup_mgr->default_restore_option.write_queue_depth > 0 || backup_mgr->default_restore_option.direct_io_size > 0)
+    {
+        if (IS_FAILURE (start_restore_writer (restore_handle)))
+        {
+            close_restore_file (restore_handle);
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+static
+int execute_cubrid_restoredb (RESTORE_HANDLE* restore_handle, const char* up_to_date, pid_t* restore_pid)
+{
+    RESTORE_OPTION* restore_opt;
+    posix_spawn_file_actions_t file_actions;
+
+    char* argv[16];
+    int idx = 0;
+
+    char cub_admin[PATH_MAX];
+    char backup_level[2];
+
+    int state = 0;
+
+    restore_opt = &backup_mgr->default_restore_option;
+
+    argv[idx ++] = "cubrid";
+
+    argv[idx ++] = "restoredb";
+
+    /* --backup-file-path */
+    argv[idx ++] = "-B";
+    argv[idx ++] = restore_handle->fifo_path;
+
+    /* --level */
+    snprintf (backup_level, 2, "%d", restore_handle->backup_level);
+
+    argv[idx ++] = "-l";
+    argv[idx ++] = backup_level;
+
+    /* --up-to-date */
+    if (IS_NOT_NULL (up_to_date))
+    {
+        argv[idx ++] = "-d";
+        argv[idx ++] = (char *)up_to_date;
+    }
+
+    /* --partial-recovery */
+    if (restore_opt->partial_recovery == true)
+    {
+        argv[idx ++] = "-p";
+    }
+
+    /* --use-database-location-path */
+    if (restore_opt->use_database_location_path == true)
+    {
+        argv[idx ++] = "-u";
+    }
+
+    argv[idx ++] = restore_handle->db_name;
+
+    argv[idx] = '\0';
+
+    snprintf (cub_admin, PATH_MAX, "%s/bin/cubrid", backup_mgr->cubrid_home);
+
+    if (IS_FAILURE (check_path_length_limit (cub_admin)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (posix_spawn_file_actions_init (&file_actions)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    // restoredb 가 묻는 것이 있어도 (다음 backup volume 등) library 를 사용하는 process 의
+    // stdin 을 기다리며 멈추지 않도록 /dev/null 을 준다.
+    if (IS_FAILURE (posix_spawn_file_actions_addopen (&file_actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (spawn_process (cub_admin, argv, &file_actions, restore_pid)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    posix_spawn_file_actions_destroy (&file_actions);
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            posix_spawn_file_actions_destroy (&file_actions);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/*
+ * cubrid restoredb 의 종료를 기다려 회수하고 exit status 를 남긴다.
+ * restore process 는 process manager 가 감시하지 않으므로 (종료를 기다릴 read 가 없다)
+ * cubrid_restore_end () 에서 fifo 를 닫은 뒤에 직접 waitpid () 한다.
+ */
+static
+int wait_restore_process (RESTORE_HANDLE* restore_handle, int wait_options)
+{
+    struct timespec now;
+    long long process_msecs;
+    pid_t retval;
+    int status;
+
+    if (restore_handle->restore_pid == -1)
+    {
+        return SUCCESS;
+    }
+
+    do
+    {
+        retval = waitpid (restore_handle->restore_pid, &status, wait_options);
+    }
+    while (retval == -1 && errno == EINTR);
+
+    if (retval == 0)
+    {
+        /* WNOHANG, still running */
+        return SUCCESS_WOULDBLOCK;
+    }
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    process_msecs = (now.tv_sec - restore_handle->restore_stat.launch_time.tv_sec) * 1000LL +
+                    (now.tv_nsec - restore_handle->restore_stat.launch_time.tv_nsec) / 1000000;
+
+    if (retval == -1)
+    {
+        // ECHILD: library 를 사용하는 process 가 SIGCHLD 를 SIG_IGN 으로 설정했거나
+        // 직접 wait () 하여 exit status 를 알 수 없다.
+        restore_handle->restore_pid = -1;
+
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    PRINT_LOG_INFO ("restore process exit, db_name => %s, pid => %d, exit_code => %d, signal => %d, "
+                    "written => %.2f GiB, process_msecs => %lld\n",
+                    restore_handle->db_name,
+                    restore_handle->restore_pid,
+                    WIFEXITED (status) ? WEXITSTATUS (status) : -1,
+                    WIFSIGNALED (status) ? WTERMSIG (status) : 0,
+                    restore_handle->write_offset / GIGABYTE,
+                    process_msecs);
+
+    restore_handle->restore_pid = -1;
+
+    /*
+     * restore process return value:
+     * 0 - restore success
+     * 1 - restore failure
+     */
+    if (!WIFEXITED (status) || IS_NOT_ZERO (WEXITSTATUS (status)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * cubrid restoredb 가 fifo 를 읽으려고 열 때까지 기다렸다가 write 쪽을 연다.
+ * reader 가 없으면 O_NONBLOCK open 은 ENXIO 로 실패하므로, 그 사이에 restoredb 가
+ * 종료되지 않았는지 (db_name 오류 등) 확인하면서 다시 시도한다.
+ * RESTORE_FIFO_OPEN_TIMEOUT_MSECS 가 지나도 열지 않으면 실패하고, restoredb 는 호출한 쪽에서 죽이고 회수한다.
+ */
+static
+int open_restore_fifo (RESTORE_HANDLE* restore_handle)
+{
+    struct timespec interval;
+    struct timespec now;
+    long long wait_msecs;
+    int flags;
+
+    interval.tv_sec  = 0;
+    interval.tv_nsec = RESTORE_FIFO_OPEN_INTERVAL_MSECS * 1000000L;
+
+    while (true)
+    {
+        restore_handle->fifo_fd = open (restore_handle->fifo_path, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+        if (restore_handle->fifo_fd != -1)
+        {
+            break;
+        }
+
+        if (errno != ENXIO && errno != EINTR)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        if (wait_restore_process (restore_handle, WNOHANG) != SUCCESS_WOULDBLOCK)
+        {
+            /* exited without opening the fifo */
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        clock_gettime (CLOCK_MONOTONIC, &now);
+
+        wait_msecs = (now.tv_sec - restore_handle->restore_stat.launch_time.tv_sec) * 1000LL +
+                     (now.tv_nsec - restore_handle->restore_stat.launch_time.tv_nsec) / 1000000;
+
+        if (wait_msecs >= RESTORE_FIFO_OPEN_TIMEOUT_MSECS)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        nanosleep (&interval, NULL);
+    }
+
+    // cubrid_restore_write () 는 restoredb 가 읽을 때까지 기다린다.
+    flags = fcntl (restore_handle->fifo_fd, F_GETFL);
+
+    if (flags == -1 || -1 == fcntl (restore_handle->fifo_fd, F_SETFL, flags & ~O_NONBLOCK))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * RESTORE_TO_DB: backup file 을 disk 에 만들지 않고 cubrid restoredb 에 fifo 로 바로 넘긴다.
+ * (backup 의 cubrid backupdb -D fifo 와 같은 방식)
+ * cubrid_restore_write () 의 data 가 fifo 로 들어가고, cubrid_restore_end () 가 fifo 를 닫으면
+ * restoredb 가 restore 를 마치고 종료하며 그 exit status 가 cubrid_restore_end () 의 결과가 된다.
+ */
+static
+int execute_restore_to_db (RESTORE_HANDLE* restore_handle, const char* up_to_date)
+{
+    pid_t restore_pid;
+
+    int state = 0;
+
+    if (IS_FAILURE (make_fifo (RESTORE_HANDLE_TYPE, restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    clock_gettime (CLOCK_MONOTONIC, &restore_handle->restore_stat.launch_time);
+
+    if (IS_FAILURE (execute_cubrid_restoredb (restore_handle, up_to_date, &restore_pid)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    restore_handle->restore_pid = restore_pid;
+
+    state = 2;
+
+    if (IS_FAILURE (open_restore_fifo (restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    PRINT_LOG_INFO ("restore process launched, db_name => %s, pid => %d, fifo_path => %s\n",
+                    restore_handle->db_name,
+                    restore_pid,
+                    restore_handle->fifo_path);
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 2:
+            if (restore_handle->restore_pid != -1)
+            {
+                killpg (restore_handle->restore_pid, SIGKILL);
+                waitpid (restore_handle->restore_pid, NULL, 0);
+
+                restore_handle->restore_pid = -1;
+            }
+        case 1:
+            close_fifo (RESTORE_HANDLE_TYPE, restore_handle);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+int begin_restore (CUBRID_RESTORE_INFO* restore_info, bool is_resumable, void** handle)
+{
+    RESTORE_HANDLE* restore_handle;
+
+    int state = 0;
+
+    if (IS_NULL (restore_info) || IS_NULL (handle))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (alloc_handle (RESTORE_HANDLE_TYPE, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    if (IS_FAILURE (set_restore_info (restore_info, is_resumable, restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (register_handle (RESTORE_HANDLE_TYPE, restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (restore_info->restore_type == RESTORE_TO_DB)
+    {
+        if (IS_FAILURE (execute_restore_to_db (restore_handle, restore_info->up_to_date)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (restore_info->restore_type == RESTORE_TO_FILE && restore_info->backup_level != CUBRID_RESTORE_ALL_LEVELS)
+    {
+        /* CUBRID_RESTORE_ALL_LEVELS: level 별 session 이 처음 write 할 때 file 을 연다. */
+        if (IS_FAILURE (execute_restore_to_file (restore_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    if (IS_FAILURE (transit_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_BEGINNING, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_unlock (&restore_handle->restore_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    *handle = get_handle_id (RESTORE_HANDLE_TYPE, restore_handle);
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            free_handle (RESTORE_HANDLE_TYPE, restore_handle);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+int end_restore (void* restore_handle_id)
+{
+    RESTORE_HANDLE* restore_handle;
+    int retval = SUCCESS;
+    int i;
+
+    int state = 0;
+
+    if (IS_NULL (restore_handle_id))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (transit_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE, HANDLE_STATE_ENDING)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // 끝나지 않은 cubrid_restore_pwrite () 를 기다린다.
+    // 이미 pwrite_lock 을 잡은 pwrite 는 restore_mutex 를 기다릴 수 있으므로 mutex 를 놓고 기다린다.
+    // 이후에 pwrite_lock 을 잡는 pwrite 는 ENDING 을 보고 restore_mutex 를 잡지 않고 실패한다.
+    pthread_mutex_unlock (&restore_handle->restore_mutex);
+
+    pthread_rwlock_wrlock (&restore_handle->pwrite_lock);
+    pthread_rwlock_unlock (&restore_handle->pwrite_lock);
+
+    pthread_mutex_lock (&restore_handle->restore_mutex);
+
+    if (restore_handle->restore_type == RESTORE_TO_DB)
+    {
+        // fifo 를 닫아 restoredb 에 backup 의 끝을 알리고 restore 가 끝나기를 기다린다.
+        close_fifo (RESTORE_HANDLE_TYPE, restore_handle);
+
+        if (IS_FAILURE (wait_restore_process (restore_handle, 0)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            retval = FAILURE;
+        }
+    }
+    else if (restore_handle->restore_type == RESTORE_TO_FILE)
+    {
+        // CUBRID_RESTORE_ALL_LEVELS: level 별 session 을 모두 끝낸다.
+        for (i = BACKUP_FULL_LEVEL; i <= BACKUP_SMALL_INCREMENT_LEVEL; i ++)
+        {
+            if (IS_NOT_NULL (restore_handle->level_handles[i]))
+            {
+                if (IS_FAILURE (end_restore (restore_handle->level_handles[i])))
+                {
+                    PRINT_LOG_ERR (ERR_INFO);
+
+                    retval = FAILURE;
+                }
+
+                restore_handle->level_handles[i] = NULL;
+            }
+        }
+
+        stop_async_io (&restore_handle->async_io);
+
+        // 걸려 있는 write 가 모두 끝난 뒤에 닫는다.
+        // write 가 실패했더라도 handle 은 정리하고 FAILURE 를 return 한다.
+        if (IS_FAILURE (stop_restore_writer (restore_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            retval = FAILURE;
+        }
+        else if (IS_FAILURE (check_restore_ranges (restore_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            retval = FAILURE;
+        }
+        else if (IS_FAILURE (trim_restore_file (restore_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            retval = FAILURE;
+        }
+        // write 가 실패한 session 은 마지막 checkpoint 를 그대로 둔다.
+        else if (restore_handle->is_resumable == true && IS_FAILURE (close_checkpoint (restore_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            retval = FAILURE;
+        }
+
+        close_restore_file (restore_handle);
+    }
+
+    if (IS_FAILURE (free_handle (RESTORE_HANDLE_TYPE, restore_handle)))
+    {
+        // ENDING 에 남으면 slot 을 다시 쓸 수 없으므로 되돌려서 cubrid_restore_end () 를 다시 호출할 수 있게 한다.
+        transit_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_ENDING, HANDLE_STATE_IN_SERVICE);
+
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (retval))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        return FAILURE;
+    }
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&restore_handle->restore_mutex);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/*
+ * buffered restore 에서 dirty page 가 쌓였다가 close 할 때 한꺼번에 writeback 되지 않도록
+ * writeback_size 만큼 쓸 때마다 그 구간의 writeback 을 시작하고 (SYNC_FILE_RANGE_WRITE),
+ * 바로 앞 구간은 writeback 이 끝나기를 기다린 뒤 page cache 에서 내린다. (POSIX_FADV_DONTNEED)
+ * 따라서 page cache 에는 restore file 의 마지막 두 구간 정도만 남는다.
+ */
+static
+int control_writeback (RESTORE_HANDLE* restore_handle)
+{
+    long long writeback_size = backup_mgr->default_restore_option.writeback_size;
+    long long offset;
+
+    if (IS_ZERO (writeback_size))
+    {
+        return SUCCESS;
+    }
+
+    /* O_DIRECT 는 page cache 를 쓰지 않는다. */
+    if (IS_NOT_NULL (restore_handle->restore_writer) && restore_handle->restore_writer->is_direct_io == true)
+    {
+        return SUCCESS;
+    }
+
+    while (restore_handle->write_offset - restore_handle->writeback_offset >= writeback_size)
+    {
+        offset = restore_handle->writeback_offset;
+
+        if (-1 == sync_file_range (restore_handle->restore_fd, offset, writeback_size, SYNC_FILE_RANGE_WRITE))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        if (offset >= writeback_size)
+        {
+            if (-1 == sync_file_range (restore_handle->restore_fd, offset - writeback_size, writeback_size,
+                                       SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
+            }
+
+            /* advisory, 실패해도 restore 에는 영향이 없다. */
+            posix_fadvise (restore_handle->restore_fd, offset - writeback_size, writeback_size, POSIX_FADV_DONTNEED);
+        }
+
+        restore_handle->writeback_offset = offset + writeback_size;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+static
+int write_data_to_file (RESTORE_HANDLE* restore_handle, int backup_level, void* buffer, unsigned int data_len)
+{
+    unsigned int queued_len;
+    int retval;
+
+    /* cubrid_restore_pwrite () 를 쓰기 시작한 session */
+    if (restore_handle->backup_level != backup_level || restore_handle->is_positional == true)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_NOT_NULL (restore_handle->restore_writer))
+    {
+        if (IS_FAILURE (queue_restore_write (restore_handle->restore_writer, buffer, data_len, true, &queued_len)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        restore_handle->write_offset = restore_handle->restore_writer->write_offset;
+    }
+    else
+    {
+        retval = write (restore_handle->restore_fd, buffer, data_len);
+
+        if (retval != data_len)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        restore_handle->write_offset += data_len;
+    }
+
+    if (IS_FAILURE (control_writeback (restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (control_checkpoint (restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * restoredb 가 먼저 종료되어 fifo 에 reader 가 없으면 write () 는 EPIPE 로 실패하는데,
+ * 이때 발생하는 SIGPIPE 로 library 를 사용하는 process 가 종료되지 않도록
+ * 호출한 thread 에서만 SIGPIPE 를 막고, 이 write 로 생긴 SIGPIPE 는 버린다.
+ */
+static
+int write_data_to_fifo (RESTORE_HANDLE* restore_handle, int backup_level, void* buffer, unsigned int data_len)
+{
+    struct timespec no_wait = {0, 0};
+    sigset_t sigpipe_mask;
+    sigset_t old_mask;
+    sigset_t pending_mask;
+    bool is_sigpipe_pending;
+    unsigned int written = 0;
+    ssize_t retval;
+
+    int state = 0;
+
+    if (restore_handle->backup_level != backup_level)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    sigemptyset (&sigpipe_mask);
+    sigaddset (&sigpipe_mask, SIGPIPE);
+
+    if (IS_FAILURE (pthread_sigmask (SIG_BLOCK, &sigpipe_mask, &old_mask)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    sigpending (&pending_mask);
+
+    is_sigpipe_pending = sigismember (&pending_mask, SIGPIPE) ? true : false;
+
+    while (written < data_len)
+    {
+        retval = write (restore_handle->fifo_fd, (char *)buffer + written, data_len - written);
+
+        if (retval == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if (errno == EPIPE && is_sigpipe_pending == false)
+            {
+                sigtimedwait (&sigpipe_mask, NULL, &no_wait);
+            }
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        written += retval;
+    }
+
+    pthread_sigmask (SIG_SETMASK, &old_mask, NULL);
+
+    restore_handle->write_offset += data_len;
+
+    if (restore_handle->write_offset - restore_handle->restore_stat.progress_offset >= RESTORE_PROGRESS_LOG_SIZE)
+    {
+        restore_handle->restore_stat.progress_offset = restore_handle->write_offset;
+
+        PRINT_LOG_INFO ("restore progress, db_name => %s, pid => %d, written => %.2f GiB\n",
+                        restore_handle->db_name,
+                        restore_handle->restore_pid,
+                        restore_handle->write_offset / GIGABYTE);
+    }
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            pthread_sigmask (SIG_SETMASK, &old_mask, NULL);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/*
+ * CUBRID_RESTORE_ALL_LEVELS session 이면 backup_level 의 session id 를 *level_handle_id 에 담는다.
+ * (처음 쓰는 level 이면 그 level 의 session 을 begin 한다.) 아니면 restore_handle_id 를 그대로 담는다.
+ * level 별 session 은 각자의 restore_mutex 로 write 하므로 level 끼리는 동시에 쓸 수 있다.
+ */
+static
+int get_level_restore_handle (void* restore_handle_id, int backup_level, void** level_handle_id)
+{
+    RESTORE_HANDLE* restore_handle;
+    CUBRID_RESTORE_INFO level_restore_info;
+
+    int state = 0;
+
+    *level_handle_id = restore_handle_id;
+
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // backup_level 은 begin 이후 바뀌지 않는다. (slot 이 재사용되었으면 아래나 호출한 곳에서 generation 확인이 실패한다.)
+    if (restore_handle->backup_level != CUBRID_RESTORE_ALL_LEVELS)
+    {
+        return SUCCESS;
+    }
+
+    if (backup_level < BACKUP_FULL_LEVEL ||
+        backup_level > BACKUP_SMALL_INCREMENT_LEVEL)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_NULL (restore_handle->level_handles[backup_level]))
+    {
+        level_restore_info.restore_type     = restore_handle->restore_type;
+        level_restore_info.backup_level     = backup_level;
+        level_restore_info.up_to_date       = NULL;
+        level_restore_info.backup_file_path = restore_handle->backup_file_path;
+        level_restore_info.db_name          = restore_handle->db_name;
+
+        if (IS_FAILURE (begin_restore (&level_restore_info, false, &restore_handle->level_handles[backup_level])))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    *level_handle_id = restore_handle->level_handles[backup_level];
+
+    if (IS_FAILURE (pthread_mutex_unlock (&restore_handle->restore_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&restore_handle->restore_mutex);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+int write_backup_data (void* restore_handle_id, int backup_level, void* buffer, unsigned int data_len)
+{
+    RESTORE_HANDLE* restore_handle;
+
+    int state = 0;
+
+    if (IS_NULL (restore_handle_id) || IS_NULL (buffer))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (get_level_restore_handle (restore_handle_id, backup_level, &restore_handle_id)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // cubrid_restore_submit_write () 를 쓰기 시작하면 restore file 은 worker thread 만 쓴다.
+    if (IS_NOT_NULL (restore_handle->async_io))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (backup_level < BACKUP_FULL_LEVEL ||
+        backup_level > BACKUP_SMALL_INCREMENT_LEVEL)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (restore_handle->restore_type == RESTORE_TO_DB)
+    {
+        if (IS_FAILURE (write_data_to_fifo (restore_handle, backup_level, buffer, data_len)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (restore_handle->restore_type == RESTORE_TO_FILE)
+    {
+        if (IS_FAILURE (write_data_to_file (restore_handle, backup_level, buffer, data_len)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    if (IS_FAILURE (pthread_mutex_unlock (&restore_handle->restore_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&restore_handle->restore_mutex);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/* volume_mutex 를 잡은 상태에서 호출한다. */
+static
+int open_restore_volume (RESTORE_HANDLE* restore_handle, int volume_index)
+{
+    char volume_file[PATH_MAX];
+
+    /* ex) demodb_bk0v001 */
+    snprintf (volume_file, PATH_MAX, "%s/%s_bk%dv%03d", restore_handle->backup_file_path,
+                                                        restore_handle->db_name,
+                                                        restore_handle->backup_level,
+                                                        volume_index);
+
+    if (IS_FAILURE (check_path_length_limit (volume_file)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    restore_handle->volumes[volume_index].volume_fd = open (volume_file, O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, S_IRUSR | S_IWUSR);
+
+    if (restore_handle->volumes[volume_index].volume_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * v000 은 write_backup_data () 와 같고, v001 부터는 volume 마다 따로 연 fd 에 쓴다.
+ * restore_mutex 대신 volume_mutex 만 잡으므로 서로 다른 volume 은 동시에 쓸 수 있다.
+ * (handle slot 은 재사용될 뿐 해제되지 않으므로 volume_mutex 는 항상 유효하다.)
+ */
+int write_backup_volume_data (void* restore_handle_id, int backup_level, int volume_index, void* buffer, unsigned int data_len)
+{
+    RESTORE_HANDLE* restore_handle;
+    RESTORE_VOLUME* volume;
+    ssize_t write_size;
+
+    int state = 0;
+
+    if (IS_ZERO (volume_index))
+    {
+        return write_backup_data (restore_handle_id, backup_level, buffer, data_len);
+    }
+
+    if (IS_NULL (restore_handle_id) || IS_NULL (buffer) || volume_index < 0 || volume_index >= MAX_RESTORE_VOLUME_COUNT)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (get_level_restore_handle (restore_handle_id, backup_level, &restore_handle_id)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    volume = &restore_handle->volumes[volume_index];
+
+    if (IS_FAILURE (pthread_mutex_lock (&volume->volume_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (restore_handle->restore_type == RESTORE_TO_DB)
+    {
+        /* Not supported yet */
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    // checkpoint 는 v000 에 대해서만 남긴다.
+    if (restore_handle->backup_level != backup_level || restore_handle->is_resumable == true)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (volume->volume_fd == -1)
+    {
+        if (IS_FAILURE (open_restore_volume (restore_handle, volume_index)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    do
+    {
+        write_size = write (volume->volume_fd, buffer, data_len);
+    } while (write_size == -1 && errno == EINTR);
+
+    if (write_size != data_len)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_unlock (&volume->volume_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&volume->volume_mutex);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/*
+ * 처음 호출될 때 session 을 positional 로 바꾼다. (restore_mutex 를 잡은 상태에서)
+ * 순서대로 쓰는 restore writer 는 멈추고, O_DIRECT 는 임의의 offset/길이를 쓸 수 없으므로 끈다.
+ */
+static
+int begin_positional_restore (RESTORE_HANDLE* restore_handle)
+{
+    int flags;
+
+    if (restore_handle->is_positional == true)
+    {
+        return SUCCESS;
+    }
+
+    // 이미 순서대로 쓰기 시작한 session 은 바꿀 수 없다. checkpoint 는 순서대로 쓴 offset 이다.
+    if (IS_NOT_ZERO (restore_handle->write_offset) || IS_NOT_NULL (restore_handle->async_io) || restore_handle->is_resumable == true)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (stop_restore_writer (restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    flags = fcntl (restore_handle->restore_fd, F_GETFL);
+
+    if (flags == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (flags & O_DIRECT)
+    {
+        if (-1 == fcntl (restore_handle->restore_fd, F_SETFL, flags & ~O_DIRECT))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    restore_handle->is_positional = true;
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * pwrite_lock 을 shared 로 잡고 restore_mutex 없이 pwrite () 하므로 여러 thread 가 동시에 쓸 수 있다.
+ * restore_mutex 는 session 을 positional 로 바꿀 때와 range map 에 더할 때만 잡는다.
+ */
+int pwrite_backup_data (void* restore_handle_id, int backup_level, long long offset, void* buffer, unsigned int data_len)
+{
+    RESTORE_HANDLE* restore_handle;
+    unsigned int written = 0;
+    ssize_t retval;
+    int restore_fd;
+
+    int state = 0;
+
+    if (IS_NULL (restore_handle_id) || IS_NULL (buffer) || offset < 0)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (get_level_restore_handle (restore_handle_id, backup_level, &restore_handle_id)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_rwlock_rdlock (&restore_handle->pwrite_lock)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    /*
+     * cubrid_restore_end () 는 restore_mutex 를 잡은 채 pwrite_lock 을 exclusive 로 다시 잡으므로 (free_handle ())
+     * ENDING 이후에 pwrite_lock 을 잡은 pwrite 가 restore_mutex 를 기다리면 서로 기다리게 된다.
+     * ENDING 은 pwrite_lock 을 exclusive 로 잡기 전에 정해지므로, 여기서 확인하고 mutex 없이 바로 실패한다.
+     */
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 2;
+
+    // lock 을 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    /* the fifo of cubrid restoredb can only be written in order */
+    if (restore_handle->restore_type == RESTORE_TO_DB || restore_handle->backup_level != backup_level)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (begin_positional_restore (restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    restore_fd = restore_handle->restore_fd;
+
+    pthread_mutex_unlock (&restore_handle->restore_mutex);
+
+    state = 1;
+
+    while (written < data_len)
+    {
+        retval = pwrite (restore_fd, (char *)buffer + written, data_len - written, offset + written);
+
+        if (retval == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        written += retval;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 2;
+
+    if (IS_NOT_ZERO (data_len))
+    {
+        if (IS_FAILURE (insert_restore_range (restore_handle, offset, offset + data_len)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    pthread_mutex_unlock (&restore_handle->restore_mutex);
+
+    pthread_rwlock_unlock (&restore_handle->pwrite_lock);
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 2:
+            pthread_mutex_unlock (&restore_handle->restore_mutex);
+        case 1:
+            pthread_rwlock_unlock (&restore_handle->pwrite_lock);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+int get_restore_pollfd (void* restore_handle_id, int* poll_fd)
+{
+    RESTORE_HANDLE* restore_handle;
+
+    int state = 0;
+
+    if (IS_NULL (restore_handle_id) || IS_NULL (poll_fd))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (restore_handle->restore_type == RESTORE_TO_DB)
+    {
+        /* Not supported yet */
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-        total_read_len += read_len;
+    /* CUBRID_RESTORE_ALL_LEVELS: level 마다 file 이 따로 있으므로 하나의 fd 로 알릴 수 없다. */
+    if (restore_handle->backup_level == CUBRID_RESTORE_ALL_LEVELS)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-        if (total_read_len == 0)
+    // restore writer 를 쓰면 write 가 끝날 때 signal 되는 eventfd 를 돌려준다.
+    if (IS_NOT_NULL (restore_handle->restore_writer))
+    {
+        *poll_fd = restore_handle->restore_writer->event_fd;
+    }
+    else
+    {
+        /*
+         * restore file 은 regular file 이므로 항상 writable 이지만, regular file 은 epoll 에 등록할 수 없다. (EPERM)
+         * 대신 signal 된 채로 두는 eventfd 를 돌려주고, write 할 때마다 다시 signal 한다.
+         */
+        if (restore_handle->event_fd == -1)
         {
-            if (backup_handle->backup_thread_state == THREAD_STATE_EXIT)
+            restore_handle->event_fd = eventfd (1, EFD_CLOEXEC | EFD_NONBLOCK);
+
+            if (restore_handle->event_fd == -1)
             {
-                *is_backup_end = true;
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
             }
         }
+
+        *poll_fd = restore_handle->event_fd;
     }
 
-    *data_len = total_read_len;
+    pthread_mutex_unlock (&restore_handle->restore_mutex);
 
     return SUCCESS;
 
 error:
 
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&restore_handle->restore_mutex);
+        default:
+            break;
+    }
+
     return FAILURE;
 }
 
-int read_backup_data (BACKUP_HANDLE* backup_handle, void* buffer, unsigned int buffer_size, unsigned int* data_len, bool* is_backup_end)
+/* resumable session 이 이어서 쓸 offset, cubrid_restore_begin () 에서 정해진다. */
+int get_resume_offset (void* restore_handle_id, long long* resume_offset)
 {
+    RESTORE_HANDLE* restore_handle;
+
     int state = 0;
 
-    if (IS_NULL (backup_handle) || IS_NULL (buffer) || IS_ZERO (buffer_size) || IS_NULL (data_len))
+    if (IS_NULL (restore_handle_id) || IS_NULL (resume_offset))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (validate_handle (BACKUP_HANDLE_TYPE, backup_handle)))
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (pthread_mutex_lock (&backup_handle->backup_mutex)))
+    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
@@ -1246,18 +4758,23 @@ int read_backup_data (BACKUP_HANDLE* backup_handle, void* buffer, unsigned int b
 
     state = 1;
 
-    if (IS_FAILURE (read_data (backup_handle, buffer, buffer_size, data_len, is_backup_end)))
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (pthread_mutex_unlock (&backup_handle->backup_mutex)))
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
+    *resume_offset = restore_handle->resume_offset;
+
+    pthread_mutex_unlock (&restore_handle->restore_mutex);
+
     return SUCCESS;
 
 error:
@@ -1265,7 +4782,7 @@ error:
     switch (state)
     {
         case 1:
-            pthread_mutex_unlock (&backup_handle->backup_mutex);
+            pthread_mutex_unlock (&restore_handle->restore_mutex);
         default:
             break;
     }
@@ -1273,91 +4790,128 @@ error:
     return FAILURE;
 }
 
-
-static
-int open_restore_file (RESTORE_HANDLE* restore_handle)
+/*
+ * restore file 의 크기를 알려주면 미리 할당하고, 다 쓰지 못하고 끝난 resumable session 은 checkpoint 를 남긴다.
+ * 이번 session 에서 아무것도 쓰기 전에만 부를 수 있다. (resume 한 session 은 checkpoint 의 크기를 이어받는다)
+ */
+int set_expected_size (void* restore_handle_id, long long expected_size)
 {
-    char restore_file[PATH_MAX];
+    RESTORE_HANDLE* restore_handle;
 
-    /* ex) demodb_bk0v000 */
-    snprintf (restore_file, PATH_MAX, "%s/%s_bk%dv000", restore_handle->backup_file_path,
-                                                        restore_handle->db_name,
-                                                        restore_handle->backup_level);
+    int state = 0;
 
-    if (IS_FAILURE (check_path_length_limit (restore_file)))
+    if (IS_NULL (restore_handle_id) || expected_size < 0)
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-#if 0
-    // 파일이 존재하면 따로 검사하지 말고, overwrite 해버리자
-    if (IS_SUCCESS (access (restore_file, F_OK)))
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
-#endif
 
-    restore_handle->restore_fd = open (restore_file, O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, S_IRUSR | S_IWUSR);
-
-    if (restore_handle->restore_fd == -1)
+    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    return SUCCESS;
+    state = 1;
 
-error:
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-    return FAILURE;
-}
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-static
-int close_restore_file (RESTORE_HANDLE* restore_handle)
-{
-    if (restore_handle->restore_fd != -1)
+    // level 마다 크기가 다르므로 CUBRID_RESTORE_ALL_LEVELS 에는 줄 수 없다.
+    if (restore_handle->restore_type != RESTORE_TO_FILE || restore_handle->backup_level == CUBRID_RESTORE_ALL_LEVELS)
     {
-        close (restore_handle->restore_fd);
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-        restore_handle->restore_fd = -1;
+    if (restore_handle->write_offset != restore_handle->resume_offset ||
+        IS_NOT_NULL (restore_handle->async_io) ||
+        restore_handle->is_positional == true)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-        restore_handle->backup_file_path[0] = '\0';
+    // 이미 정해진 크기 (이전 call 이나 checkpoint) 와 다른 크기로 바꿀 수 없다.
+    if (IS_NOT_ZERO (restore_handle->expected_size) && restore_handle->expected_size != expected_size)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        PRINT_LOG_INFO ("expected_size does not match, expected_size => %lld, requested => %lld\n",
+                        restore_handle->expected_size,
+                        expected_size);
+        goto error;
     }
 
-    return SUCCESS;
-}
+    restore_handle->expected_size = expected_size;
 
-static
-int execute_restore_to_file (RESTORE_HANDLE* restore_handle)
-{
-    if (IS_FAILURE (open_restore_file (restore_handle)))
+    if (IS_FAILURE (preallocate_restore_file (restore_handle)))
     {
+        restore_handle->expected_size = 0;
+
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
+    pthread_mutex_unlock (&restore_handle->restore_mutex);
+
     return SUCCESS;
 
 error:
 
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&restore_handle->restore_mutex);
+        default:
+            break;
+    }
+
     return FAILURE;
 }
 
-int begin_restore (CUBRID_RESTORE_INFO* restore_info, void** handle)
+/*
+ * write () 를 한 번만 호출하고 쓴 만큼을 written 으로 돌려준다.
+ * *written == 0: 지금은 쓸 수 없다. (EAGAIN)
+ * regular file 은 O_NONBLOCK 이 의미가 없으므로 restore writer 가 없으면 (write_queue_depth=0)
+ * 이 write () 는 cubrid_restore_write () 처럼 page cache 에 들어갈 때까지 기다린다.
+ */
+int write_backup_data_nb (void* restore_handle_id, int backup_level, void* buffer, unsigned int data_len, unsigned int* written)
 {
     RESTORE_HANDLE* restore_handle;
+    ssize_t write_size;
+    int retval;
 
     int state = 0;
 
-    if (IS_NULL (restore_info) || IS_NULL (handle))
+    if (IS_NULL (restore_handle_id) || IS_NULL (buffer) || IS_NULL (written))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (alloc_handle (RESTORE_HANDLE_TYPE, (void **)&restore_handle)))
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
@@ -1365,21 +4919,95 @@ int begin_restore (CUBRID_RESTORE_INFO* restore_info, void** handle)
 
     state = 1;
 
-    if (IS_FAILURE (set_restore_info (restore_info, restore_handle)))
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (restore_info->restore_type == RESTORE_TO_DB)
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (restore_handle->restore_type == RESTORE_TO_DB)
     {
         /* Not supported yet */
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
-    else if (restore_info->restore_type == RESTORE_TO_FILE)
+
+    if (restore_handle->backup_level != backup_level || IS_NOT_NULL (restore_handle->async_io) || restore_handle->is_positional == true)
     {
-        if (IS_FAILURE (execute_restore_to_file (restore_handle)))
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    *written = 0;
+
+    if (IS_NOT_NULL (restore_handle->restore_writer))
+    {
+        retval = queue_restore_write (restore_handle->restore_writer, buffer, data_len, false, written);
+
+        if (retval == FAILURE)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        restore_handle->write_offset = restore_handle->restore_writer->write_offset;
+
+        if (IS_FAILURE (control_writeback (restore_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        if (IS_FAILURE (control_checkpoint (restore_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        pthread_mutex_unlock (&restore_handle->restore_mutex);
+
+        return SUCCESS;
+    }
+
+    do
+    {
+        write_size = write (restore_handle->restore_fd, buffer, data_len);
+    } while (write_size == -1 && errno == EINTR);
+
+    if (write_size == -1)
+    {
+        if (errno != EAGAIN)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else
+    {
+        *written = write_size;
+
+        restore_handle->write_offset += write_size;
+
+        // 호출하는 쪽이 pollfd 를 비웠더라도 다음 write 를 할 수 있음을 다시 알린다.
+        if (restore_handle->event_fd != -1)
+        {
+            signal_event_fd (restore_handle->event_fd);
+        }
+
+        if (IS_FAILURE (control_writeback (restore_handle)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        if (IS_FAILURE (control_checkpoint (restore_handle)))
         {
             PRINT_LOG_ERR (ERR_INFO);
             goto error;
@@ -1392,8 +5020,6 @@ int begin_restore (CUBRID_RESTORE_INFO* restore_info, void** handle)
         goto error;
     }
 
-    *(RESTORE_HANDLE **)handle = restore_handle;
-
     return SUCCESS;
 
 error:
@@ -1401,7 +5027,7 @@ error:
     switch (state)
     {
         case 1:
-            free_handle (RESTORE_HANDLE_TYPE, restore_handle);
+            pthread_mutex_unlock (&restore_handle->restore_mutex);
         default:
             break;
     }
@@ -1409,17 +5035,31 @@ error:
     return FAILURE;
 }
 
-int end_restore (RESTORE_HANDLE* restore_handle)
+/* cubrid_restore_submit_write () 로 들어온 buffer 하나를 쓴다. (worker thread, restore_mutex 없이) */
+static
+int write_async_backup_data (void* handle, ASYNC_IO_ENTRY* entry)
 {
-    int state = 0;
+    RESTORE_HANDLE* restore_handle = (RESTORE_HANDLE *)handle;
 
-    if (IS_NULL (restore_handle))
+    if (IS_FAILURE (write_data_to_file (restore_handle, entry->backup_level, entry->buffer, entry->buffer_size)))
     {
         PRINT_LOG_ERR (ERR_INFO);
-        goto error;
+        return FAILURE;
     }
 
-    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle)))
+    entry->data_len = entry->buffer_size;
+
+    return SUCCESS;
+}
+
+static
+int start_restore_async_io (void* restore_handle_id, ASYNC_IO** async_io)
+{
+    RESTORE_HANDLE* restore_handle;
+
+    int state = 0;
+
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
@@ -1433,23 +5073,44 @@ int end_restore (RESTORE_HANDLE* restore_handle)
 
     state = 1;
 
-    if (restore_handle->restore_type == RESTORE_TO_DB)
+    // mutex 를 기다리는 동안 slot 이 재사용되었을 수 있으므로 generation 을 다시 확인한다.
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
     {
-        /* Not supported yet */
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
-    else if (restore_handle->restore_type == RESTORE_TO_FILE)
+
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
     {
-        close_restore_file (restore_handle);
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
     }
 
-    if (IS_FAILURE (free_handle (RESTORE_HANDLE_TYPE, restore_handle)))
+    if (restore_handle->restore_type == RESTORE_TO_DB || restore_handle->backup_level == CUBRID_RESTORE_ALL_LEVELS ||
+        restore_handle->is_positional == true)
     {
+        /* Not supported yet */
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
+    if (IS_NULL (restore_handle->async_io))
+    {
+        if (IS_FAILURE (start_async_io (restore_handle, write_async_backup_data, async_io)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        __atomic_store_n (&restore_handle->async_io, *async_io, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        *async_io = restore_handle->async_io;
+    }
+
+    pthread_mutex_unlock (&restore_handle->restore_mutex);
+
     return SUCCESS;
 
 error:
@@ -1465,79 +5126,97 @@ error:
     return FAILURE;
 }
 
-static
-int write_data_to_file (RESTORE_HANDLE* restore_handle, int backup_level, void* buffer, unsigned int data_len)
+/* returns SUCCESS_WOULDBLOCK if the submission queue is full */
+int submit_backup_write (void* restore_handle_id, int backup_level, void* buffer, unsigned int data_len, void* user_data)
 {
-    int retval;
+    RESTORE_HANDLE* restore_handle;
+    ASYNC_IO* async_io;
+    ASYNC_IO_ENTRY entry;
 
-    if (restore_handle->backup_level != backup_level)
+    if (IS_NULL (restore_handle_id) || IS_NULL (buffer))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (backup_level < BACKUP_FULL_LEVEL ||
+        backup_level > BACKUP_SMALL_INCREMENT_LEVEL)
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    retval = write (restore_handle->restore_fd, buffer, data_len);
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
 
-    if (retval != data_len)
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    return SUCCESS;
+    async_io = __atomic_load_n (&restore_handle->async_io, __ATOMIC_ACQUIRE);
+
+    if (IS_NULL (async_io))
+    {
+        if (IS_FAILURE (start_restore_async_io (restore_handle_id, &async_io)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    entry.buffer       = buffer;
+    entry.buffer_size  = data_len;
+    entry.data_len     = 0;
+    entry.backup_level = backup_level;
+    entry.result       = FAILURE;
+    entry.user_data    = user_data;
+
+    return submit_async_io (async_io, &entry);
 
 error:
 
     return FAILURE;
 }
 
-int write_backup_data (RESTORE_HANDLE* restore_handle, int backup_level, void* buffer, unsigned int data_len)
+int reap_restore_data (void* restore_handle_id, CUBRID_IO_COMPLETION* completions, unsigned int max_count, int timeout_msecs, unsigned int* count)
 {
-    int state = 0;
+    RESTORE_HANDLE* restore_handle;
+    ASYNC_IO* async_io;
 
-    if (IS_NULL (restore_handle) || IS_NULL (buffer))
+    if (IS_NULL (restore_handle_id) || IS_NULL (completions) || IS_ZERO (max_count) || IS_NULL (count) || timeout_msecs < -1)
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle)))
+    if (IS_FAILURE (validate_handle (RESTORE_HANDLE_TYPE, restore_handle_id, (void **)&restore_handle)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (pthread_mutex_lock (&restore_handle->restore_mutex)))
+    if (IS_FAILURE (check_handle_state (RESTORE_HANDLE_TYPE, restore_handle, HANDLE_STATE_IN_SERVICE)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    state = 1;
+    async_io = __atomic_load_n (&restore_handle->async_io, __ATOMIC_ACQUIRE);
 
-    if (backup_level < BACKUP_FULL_LEVEL ||
-        backup_level > BACKUP_SMALL_INCREMENT_LEVEL)
+    if (IS_NULL (async_io))
     {
-        PRINT_LOG_ERR (ERR_INFO);
-        goto error;
-    }
+        /* nothing has been submitted */
+        *count = 0;
 
-    if (restore_handle->restore_type == RESTORE_TO_DB)
-    {
-        /* Not supported yet */
-        PRINT_LOG_ERR (ERR_INFO);
-        goto error;
-    }
-    else if (restore_handle->restore_type == RESTORE_TO_FILE)
-    {
-        if (IS_FAILURE (write_data_to_file (restore_handle, backup_level, buffer, data_len)))
-        {
-            PRINT_LOG_ERR (ERR_INFO);
-            goto error;
-        }
+        return SUCCESS;
     }
 
-    if (IS_FAILURE (pthread_mutex_unlock (&restore_handle->restore_mutex)))
+    if (IS_FAILURE (reap_async_io (async_io, completions, max_count, timeout_msecs, count)))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
@@ -1547,13 +5226,5 @@ int write_backup_data (RESTORE_HANDLE* restore_handle, int backup_level, void* b
 
 error:
 
-    switch (state)
-    {
-        case 1:
-            pthread_mutex_unlock (&restore_handle->restore_mutex);
-        default:
-            break;
-    }
-
     return FAILURE;
 }
@@ -1,19 +1,25 @@
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <regex.h>
 #include <time.h>
 #include <sys/timeb.h>
 #include <errno.h>
 #include <assert.h>
+#include <pthread.h>
 #include "backup_manager.h"
 
 #define INT_MAX 2147483647
+#define LLONG_MAX 9223372036854775807LL
 
 #define LOG_HEADER_MAX_SIZE  (50)
 #define LOG_MESSAGE_MAX_SIZE (LOG_HEADER_MAX_SIZE + 1024)
 
 BACKUP_MANAGER backup_manager;
 
+// 여러 backup/restore 세션이 동시에 로그를 남기므로 log_buffer 를 보호한다.
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 BACKUP_MANAGER* backup_mgr = &backup_manager;
 
 static
@@ -62,6 +68,8 @@ int print_log (const char *prefix_str, const char *msg, ...)
         return SUCCESS;
     }
 
+    pthread_mutex_lock (&log_mutex);
+
     p = log_buffer;
     len = LOG_MESSAGE_MAX_SIZE;
     n = make_log_header (p, len, prefix_str);
@@ -79,9 +87,11 @@ int print_log (const char *prefix_str, const char *msg, ...)
         va_end (arg_list);
     }
 
-    fprintf (backup_mgr->log_fp, log_buffer);
+    fprintf (backup_mgr->log_fp, "%s", log_buffer);
     fflush (backup_mgr->log_fp);
 
+    pthread_mutex_unlock (&log_mutex);
+
     return SUCCESS;
 }
 
@@ -214,6 +224,29 @@ error:
     return FAILURE;
 }
 
+/* eventfd 를 읽는 쪽을 깨운다. (async_io, read_ahead, process_manager, restore_writer 에서 같이 쓴다.) */
+void signal_event_fd (int event_fd)
+{
+    uint64_t value = 1;
+
+    if (-1 == write (event_fd, &value, sizeof (value)))
+    {
+        /* EAGAIN: the counter is already set */
+        if (errno != EAGAIN)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+        }
+    }
+}
+
+void drain_event_fd (int event_fd)
+{
+    uint64_t value;
+
+    /* EAGAIN: not signaled */
+    read (event_fd, &value, sizeof (value));
+}
+
 static
 int set_cubrid_home (void)
 {
@@ -360,6 +393,11 @@ int init_default_backup_option (void)
     backup_opt->compress           = false; /* [M] */
     backup_opt->except_active_log  = false; /* [M] */
     backup_opt->sleep_msecs        = 0;     /* [M] */
+    backup_opt->pipe_size          = 0;
+    backup_opt->max_handle_count   = DEFAULT_MAX_HANDLE_COUNT;
+    backup_opt->read_timeout_msecs = DEFAULT_READ_TIMEOUT_MSECS;
+    backup_opt->read_ahead_size    = 0;
+    backup_opt->spill_size         = 0;
  
     return SUCCESS;
 }
@@ -373,6 +411,11 @@ int init_default_restore_option (void)
 
     restore_opt->partial_recovery           = false;
     restore_opt->use_database_location_path = false;
+    restore_opt->max_handle_count           = DEFAULT_MAX_HANDLE_COUNT;
+    restore_opt->write_queue_depth          = 0;
+    restore_opt->direct_io_size             = 0;
+    restore_opt->writeback_size             = 0;
+    restore_opt->checkpoint_size            = DEFAULT_CHECKPOINT_SIZE;
 
     return SUCCESS;
 }
@@ -447,6 +490,103 @@ error:
     return FAILURE;
 }
 
+/* ex) 65536, 64K, 1M, 100G */
+static
+int set_long_size_value (long long* dest, char* src)
+{
+    char number[24];
+    int value_len;
+    long long unit = 1;
+    int i;
+
+    value_len = strlen (src);
+
+    if (IS_ZERO (value_len) || value_len >= sizeof (number))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    snprintf (number, sizeof (number), "%s", src);
+
+    switch (number[value_len - 1])
+    {
+        case 'k':
+        case 'K':
+            unit = 1024LL;
+            break;
+        case 'm':
+        case 'M':
+            unit = 1024LL * 1024;
+            break;
+        case 'g':
+        case 'G':
+            unit = 1024LL * 1024 * 1024;
+            break;
+        default:
+            break;
+    }
+
+    if (unit != 1)
+    {
+        number[value_len - 1] = '\0';
+    }
+
+    // 숫자 없이 단위만 있는 값 ("M") 은 0 으로 읽지 않는다.
+    if (IS_ZERO (strlen (number)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    for (i = 0; i < strlen (number); i++)
+    {
+        if (number[i] < '0' || number[i] > '9')
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    errno = 0;
+
+    *dest = strtoll (number, NULL, 10);
+
+    if (errno == ERANGE || *dest > LLONG_MAX / unit)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    *dest *= unit;
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+static
+int set_size_value (int* dest, char* src)
+{
+    long long long_val;
+
+    if (IS_FAILURE (set_long_size_value (&long_val, src)) || long_val > INT_MAX)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    *dest = (int) long_val;
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
 static
 int set_backup_option (char* key, char* value)
 {
@@ -510,6 +650,46 @@ int set_backup_option (char* key, char* value)
             goto error;
         }
     }
+    else if (IS_ZERO (strncasecmp (key, "pipe_size", 10)))
+    {
+        if (IS_FAILURE (set_size_value (&backup_opt->pipe_size, value)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (IS_ZERO (strncasecmp (key, "max_handle_count", 17)))
+    {
+        if (IS_FAILURE (set_int_value (&backup_opt->max_handle_count, value)) || backup_opt->max_handle_count <= 0)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (IS_ZERO (strncasecmp (key, "read_timeout_msecs", 19)))
+    {
+        if (IS_FAILURE (set_int_value (&backup_opt->read_timeout_msecs, value)) || backup_opt->read_timeout_msecs < 0)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (IS_ZERO (strncasecmp (key, "read_ahead_size", 16)))
+    {
+        if (IS_FAILURE (set_size_value (&backup_opt->read_ahead_size, value)) || backup_opt->read_ahead_size < 0)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (IS_ZERO (strncasecmp (key, "spill_size", 11)))
+    {
+        if (IS_FAILURE (set_long_size_value (&backup_opt->spill_size, value)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
     else
     {
         PRINT_LOG_ERR (ERR_INFO);
@@ -546,6 +726,48 @@ int set_restore_option (char* key, char* value)
             goto error;
         }
     }
+    else if (0 == strncasecmp (key, "max_handle_count", 17))
+    {
+        if (IS_FAILURE (set_int_value (&restore_opt->max_handle_count, value)) || restore_opt->max_handle_count <= 0)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (0 == strncasecmp (key, "write_queue_depth", 18))
+    {
+        if (IS_FAILURE (set_int_value (&restore_opt->write_queue_depth, value)) ||
+            restore_opt->write_queue_depth < 0 || restore_opt->write_queue_depth > MAX_WRITE_QUEUE_DEPTH)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (0 == strncasecmp (key, "direct_io_size", 15))
+    {
+        if (IS_FAILURE (set_size_value (&restore_opt->direct_io_size, value)) ||
+            restore_opt->direct_io_size < 0 || restore_opt->direct_io_size % DIRECT_IO_ALIGN != 0)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (0 == strncasecmp (key, "writeback_size", 15))
+    {
+        if (IS_FAILURE (set_size_value (&restore_opt->writeback_size, value)) || restore_opt->writeback_size < 0)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    else if (0 == strncasecmp (key, "checkpoint_size", 16))
+    {
+        if (IS_FAILURE (set_long_size_value (&restore_opt->checkpoint_size, value)) || restore_opt->checkpoint_size <= 0)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
     else
     {
         PRINT_LOG_ERR (ERR_INFO);
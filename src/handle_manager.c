@@ -1,38 +1,220 @@
+#include <stdlib.h>
 #include <errno.h>
+#include <sys/eventfd.h>
+#include <sys/wait.h>
 #include "handle_manager.h"
+#include "async_io.h"
+#include "process_manager.h"
+#include "read_ahead.h"
+#include "restore_writer.h"
 
 HANDLE_MANAGER handle_manager;
 
 HANDLE_MANAGER* handle_mgr = &handle_manager;
 
+static
+void destroy_restore_volumes (RESTORE_HANDLE* restore_handle, int volume_count)
+{
+    int i;
+
+    for (i = 1; i < volume_count; i ++)
+    {
+        pthread_mutex_destroy (&restore_handle->volumes[i].volume_mutex);
+    }
+}
+
+static
+int init_restore_volumes (RESTORE_HANDLE* restore_handle)
+{
+    int i;
+
+    for (i = 1; i < MAX_RESTORE_VOLUME_COUNT; i ++)
+    {
+        if (IS_FAILURE (pthread_mutex_init (&restore_handle->volumes[i].volume_mutex, NULL)))
+        {
+            destroy_restore_volumes (restore_handle, i);
+
+            PRINT_LOG_ERR (ERR_INFO);
+            return FAILURE;
+        }
+
+        restore_handle->volumes[i].volume_fd = -1;
+    }
+
+    return SUCCESS;
+}
+
 static
 int initialize_handle_manager (void)
 {
-    if (IS_FAILURE (pthread_mutex_init (&handle_mgr->backup_handle.backup_mutex, NULL)))
+    int backup_mutex_count = 0;
+    int restore_mutex_count = 0;
+    int i;
+
+    int state = 0;
+
+    if (IS_FAILURE (pthread_mutex_init (&handle_mgr->handle_mgr_mutex, NULL)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    handle_mgr->max_backup_handle_count  = backup_mgr->default_backup_option.max_handle_count;
+    handle_mgr->max_restore_handle_count = backup_mgr->default_restore_option.max_handle_count;
+
+    if (handle_mgr->max_backup_handle_count > MAX_HANDLE_SLOT_COUNT ||
+        handle_mgr->max_restore_handle_count > MAX_HANDLE_SLOT_COUNT)
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
-    if (IS_FAILURE (pthread_mutex_init (&handle_mgr->restore_handle.restore_mutex, NULL)))
+    handle_mgr->backup_handles  = (BACKUP_HANDLE *)calloc (handle_mgr->max_backup_handle_count, sizeof (BACKUP_HANDLE));
+    handle_mgr->restore_handles = (RESTORE_HANDLE *)calloc (handle_mgr->max_restore_handle_count, sizeof (RESTORE_HANDLE));
+
+    if (IS_NULL (handle_mgr->backup_handles) || IS_NULL (handle_mgr->restore_handles))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
     }
 
+    for (i = 0; i < handle_mgr->max_backup_handle_count; i ++)
+    {
+        if (IS_FAILURE (pthread_mutex_init (&handle_mgr->backup_handles[i].backup_mutex, NULL)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        /* cubrid_backup_cancel () 는 handle 이 free 되는 중에도 호출될 수 있으므로 slot 과 수명을 같이 한다. */
+        handle_mgr->backup_handles[i].cancel_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        if (handle_mgr->backup_handles[i].cancel_fd == -1)
+        {
+            pthread_mutex_destroy (&handle_mgr->backup_handles[i].backup_mutex);
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        handle_mgr->backup_handles[i].exit_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        if (handle_mgr->backup_handles[i].exit_fd == -1)
+        {
+            close (handle_mgr->backup_handles[i].cancel_fd);
+            pthread_mutex_destroy (&handle_mgr->backup_handles[i].backup_mutex);
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        backup_mutex_count ++;
+
+        /* generation 0 is never used, so that a zeroed id never validates */
+        handle_mgr->backup_handles[i].generation = 1;
+        handle_mgr->backup_handles[i].slot_index = i;
+    }
+
+    for (i = 0; i < handle_mgr->max_restore_handle_count; i ++)
+    {
+        if (IS_FAILURE (init_restore_volumes (&handle_mgr->restore_handles[i])))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        if (IS_FAILURE (pthread_mutex_init (&handle_mgr->restore_handles[i].restore_mutex, NULL)))
+        {
+            destroy_restore_volumes (&handle_mgr->restore_handles[i], MAX_RESTORE_VOLUME_COUNT);
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        if (IS_FAILURE (pthread_rwlock_init (&handle_mgr->restore_handles[i].pwrite_lock, NULL)))
+        {
+            pthread_mutex_destroy (&handle_mgr->restore_handles[i].restore_mutex);
+            destroy_restore_volumes (&handle_mgr->restore_handles[i], MAX_RESTORE_VOLUME_COUNT);
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        restore_mutex_count ++;
+
+        handle_mgr->restore_handles[i].generation = 1;
+        handle_mgr->restore_handles[i].slot_index = i;
+    }
+
     return SUCCESS;
 
 error:
 
+    switch (state)
+    {
+        case 1:
+            for (i = 0; i < backup_mutex_count; i ++)
+            {
+                pthread_mutex_destroy (&handle_mgr->backup_handles[i].backup_mutex);
+                close (handle_mgr->backup_handles[i].cancel_fd);
+                close (handle_mgr->backup_handles[i].exit_fd);
+            }
+
+            for (i = 0; i < restore_mutex_count; i ++)
+            {
+                pthread_rwlock_destroy (&handle_mgr->restore_handles[i].pwrite_lock);
+                pthread_mutex_destroy (&handle_mgr->restore_handles[i].restore_mutex);
+                destroy_restore_volumes (&handle_mgr->restore_handles[i], MAX_RESTORE_VOLUME_COUNT);
+            }
+
+            free (handle_mgr->backup_handles);
+            free (handle_mgr->restore_handles);
+
+            handle_mgr->backup_handles  = NULL;
+            handle_mgr->restore_handles = NULL;
+
+            handle_mgr->max_backup_handle_count  = 0;
+            handle_mgr->max_restore_handle_count = 0;
+
+            pthread_mutex_destroy (&handle_mgr->handle_mgr_mutex);
+        default:
+            break;
+    }
+
     return FAILURE;
 }
 
 static
 int finalize_handle_manager (void)
 {
-    pthread_mutex_destroy (&handle_mgr->backup_handle.backup_mutex);
+    int i;
+
+    for (i = 0; i < handle_mgr->max_backup_handle_count; i ++)
+    {
+        pthread_mutex_destroy (&handle_mgr->backup_handles[i].backup_mutex);
+        close (handle_mgr->backup_handles[i].cancel_fd);
+        close (handle_mgr->backup_handles[i].exit_fd);
+    }
+
+    for (i = 0; i < handle_mgr->max_restore_handle_count; i ++)
+    {
+        pthread_rwlock_destroy (&handle_mgr->restore_handles[i].pwrite_lock);
+        pthread_mutex_destroy (&handle_mgr->restore_handles[i].restore_mutex);
+        destroy_restore_volumes (&handle_mgr->restore_handles[i], MAX_RESTORE_VOLUME_COUNT);
+    }
+
+    free (handle_mgr->backup_handles);
+    free (handle_mgr->restore_handles);
+
+    handle_mgr->backup_handles  = NULL;
+    handle_mgr->restore_handles = NULL;
 
-    pthread_mutex_destroy (&handle_mgr->restore_handle.restore_mutex);
+    handle_mgr->max_backup_handle_count  = 0;
+    handle_mgr->max_restore_handle_count = 0;
+
+    pthread_mutex_destroy (&handle_mgr->handle_mgr_mutex);
 
     return SUCCESS;
 }
@@ -40,9 +222,12 @@ int finalize_handle_manager (void)
 static
 int initialize_backup_handle (BACKUP_HANDLE* backup_handle)
 {
-    backup_handle->backup_thread_state = THREAD_STATE_NO_SPAWN;
+    __atomic_store_n (&backup_handle->backup_process_state, PROCESS_STATE_NO_SPAWN, __ATOMIC_RELEASE);
 
-    backup_handle->is_cancel = false;
+    backup_handle->backup_pid  = -1;
+    backup_handle->pid_fd      = -1;
+    backup_handle->is_cancel   = false;
+    backup_handle->kill_signal = 0;
 
     backup_handle->backup_level   = BACKUP_FULL_LEVEL;
     backup_handle->remove_archive = false;
@@ -51,32 +236,44 @@ int initialize_backup_handle (BACKUP_HANDLE* backup_handle)
     backup_handle->compress       = false;
 
     backup_handle->fifo_fd = -1;
+    backup_handle->pipe_size = 0;
     backup_handle->fifo_path[0] = '\0';
 
+    backup_handle->read_lowat = 0;
+
+    backup_handle->read_ahead = NULL;
+
+    backup_handle->poll_fd = -1;
+
+    backup_handle->async_io = NULL;
+
     backup_handle->db_name[0] = '\0';
 
+    memset (&backup_handle->backup_stat, 0, sizeof (BACKUP_STAT));
+
     return SUCCESS;
 }
 
 static
 int finalize_backup_handle (BACKUP_HANDLE* backup_handle)
 {
-    if (backup_handle->backup_thread_state == THREAD_STATE_RUNNING)
+    // backup process 가 아직 수행 중이면 종료를 요청하고 supervisor 가 회수할 때까지 기다린다.
+    // 회수 전에 handle 을 초기화하면 -D (fifo) 경로가 사라져
+    // 서버에서 아래와 같은 에러가 발생한다.
+    // ERROR: Destination-path does not exist or is not a directory.
+    if (get_process_state (backup_handle) == PROCESS_STATE_RUNNING)
     {
-        backup_handle->is_cancel = true;
+        cancel_backup_process (backup_handle);
+        wait_backup_process (backup_handle);
+    }
+
+    stop_async_io (&backup_handle->async_io);
+
+    stop_read_ahead (backup_handle);
 
-        // thread 상태 변경 후 create 하기 때문에 생성 실패시 hang 발생할 수 있다.
-        // (생성 실패하였는데, 상태는 THREAD_STATE_RUNNING 이기 때문에)
-        // 상태를 먼저 변경하는 이유는
-        // cubrid_backup_finalize () 호출 시 thread 상태가 THREAD_STATE_RUNNING 로 바뀌기 전이라면,
-        // 이 부분을 pass 하고, 내부 handle을 free하기 때문에
-        // 서버에서 아래와 같은 에러가 발생한다.
-        // ERROR: Destination-path does not exist or is not a directory.
-        // 
-        // 이는 handle에 있던 -D (fifo) 경로를 아래 initialize_backup_handle () 함수에서
-        // 초기화하기 때문이다.
-        // 이 구조적인 문제는 다음 버전에서 개선하기로 한다.
-        pthread_join (backup_handle->backup_thread, NULL);
+    if (backup_handle->poll_fd != -1)
+    {
+        close (backup_handle->poll_fd);
     }
 
     if (backup_handle->fifo_fd != -1)
@@ -93,6 +290,8 @@ int finalize_backup_handle (BACKUP_HANDLE* backup_handle)
 static
 int initialize_restore_handle (RESTORE_HANDLE* restore_handle)
 {
+    int i;
+
     restore_handle->restore_type = -1;
 
     restore_handle->backup_level = BACKUP_FULL_LEVEL;
@@ -100,21 +299,102 @@ int initialize_restore_handle (RESTORE_HANDLE* restore_handle)
     restore_handle->restore_fd = -1;
     restore_handle->backup_file_path[0] = '\0';
 
+    restore_handle->async_io = NULL;
+
+    restore_handle->restore_writer = NULL;
+
+    restore_handle->event_fd = -1;
+
+    restore_handle->is_positional  = false;
+    restore_handle->ranges         = NULL;
+    restore_handle->range_count    = 0;
+    restore_handle->range_capacity = 0;
+
+    restore_handle->restore_pid  = -1;
+    restore_handle->fifo_fd      = -1;
+    restore_handle->fifo_path[0] = '\0';
+
+    restore_handle->expected_size    = 0;
+    restore_handle->write_offset     = 0;
+    restore_handle->writeback_offset = 0;
+
+    restore_handle->is_resumable      = false;
+    restore_handle->resume_offset     = 0;
+    restore_handle->checkpoint_offset = 0;
+
+    for (i = BACKUP_FULL_LEVEL; i <= BACKUP_SMALL_INCREMENT_LEVEL; i ++)
+    {
+        restore_handle->level_handles[i] = NULL;
+    }
+
     restore_handle->db_name[0] = '\0';
 
+    memset (&restore_handle->restore_stat, 0, sizeof (RESTORE_STAT));
+
     return SUCCESS;
 }
 
 static
 int finalize_restore_handle (RESTORE_HANDLE* restore_handle)
 {
+    int i;
+
+    // 끝나지 않은 cubrid_restore_pwrite () 를 기다린 뒤에 restore_fd 를 닫는다.
+    pthread_rwlock_wrlock (&restore_handle->pwrite_lock);
+
+    stop_async_io (&restore_handle->async_io);
+
+    stop_restore_writer (restore_handle);
+
+    // cubrid_restore_end () 없이 정리되는 RESTORE_TO_DB session 이면
+    // 받다 만 backup 으로 restore 가 끝나지 않도록 cubrid restoredb 를 죽이고 회수한다.
+    if (restore_handle->fifo_fd != -1)
+    {
+        close (restore_handle->fifo_fd);
+    }
+
+    if (restore_handle->restore_pid != -1)
+    {
+        killpg (restore_handle->restore_pid, SIGKILL);
+        waitpid (restore_handle->restore_pid, NULL, 0);
+    }
+
+    if (restore_handle->fifo_path[0] != '\0')
+    {
+        unlink (restore_handle->fifo_path);
+    }
+
     if (restore_handle->restore_fd != -1)
     {
         close (restore_handle->restore_fd);
     }
 
+    if (restore_handle->event_fd != -1)
+    {
+        close (restore_handle->event_fd);
+    }
+
+    // volume 에 write 중인 thread 가 끝나기를 기다린 뒤에 닫는다.
+    for (i = 1; i < MAX_RESTORE_VOLUME_COUNT; i ++)
+    {
+        pthread_mutex_lock (&restore_handle->volumes[i].volume_mutex);
+
+        if (restore_handle->volumes[i].volume_fd != -1)
+        {
+            close (restore_handle->volumes[i].volume_fd);
+
+            restore_handle->volumes[i].volume_fd = -1;
+        }
+
+        pthread_mutex_unlock (&restore_handle->volumes[i].volume_mutex);
+    }
+
+    free (restore_handle->ranges);
+
     initialize_restore_handle (restore_handle);
 
+    pthread_rwlock_unlock (&restore_handle->pwrite_lock);
+
     return SUCCESS;
 }
 
@@ -135,16 +415,34 @@ error:
 
 int stop_handle_manager (void)
 {
-    if (IS_FAILURE (free_handle (BACKUP_HANDLE_TYPE, &handle_mgr->backup_handle)))
+    int i;
+
+    for (i = 0; i < handle_mgr->max_backup_handle_count; i ++)
     {
-        PRINT_LOG_ERR (ERR_INFO);
-        goto error;
+        if (__atomic_load_n (&handle_mgr->backup_handles[i].handle_state, __ATOMIC_ACQUIRE) == HANDLE_STATE_FREE)
+        {
+            continue;
+        }
+
+        if (IS_FAILURE (free_handle (BACKUP_HANDLE_TYPE, &handle_mgr->backup_handles[i])))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
     }
 
-    if (IS_FAILURE (free_handle (RESTORE_HANDLE_TYPE, &handle_mgr->restore_handle)))
+    for (i = 0; i < handle_mgr->max_restore_handle_count; i ++)
     {
-        PRINT_LOG_ERR (ERR_INFO);
-        goto error;
+        if (__atomic_load_n (&handle_mgr->restore_handles[i].handle_state, __ATOMIC_ACQUIRE) == HANDLE_STATE_FREE)
+        {
+            continue;
+        }
+
+        if (IS_FAILURE (free_handle (RESTORE_HANDLE_TYPE, &handle_mgr->restore_handles[i])))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
     }
 
     if (IS_FAILURE (finalize_handle_manager ()))
@@ -160,6 +458,73 @@ error:
     return FAILURE;
 }
 
+static
+void* reserve_handle_slot (HANDLE_TYPE handle_type)
+{
+    void* handle = NULL;
+    int i;
+
+    if (IS_FAILURE (pthread_mutex_lock (&handle_mgr->handle_mgr_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        return NULL;
+    }
+
+    if (handle_type == BACKUP_HANDLE_TYPE)
+    {
+        for (i = 0; i < handle_mgr->max_backup_handle_count; i ++)
+        {
+            if (__atomic_load_n (&handle_mgr->backup_handles[i].handle_state, __ATOMIC_ACQUIRE) == HANDLE_STATE_FREE)
+            {
+                __atomic_store_n (&handle_mgr->backup_handles[i].handle_state, HANDLE_STATE_BEGINNING, __ATOMIC_RELEASE);
+                handle_mgr->backup_handles[i].is_registered = false;
+
+                handle = &handle_mgr->backup_handles[i];
+
+                break;
+            }
+        }
+    }
+    else if (handle_type == RESTORE_HANDLE_TYPE)
+    {
+        for (i = 0; i < handle_mgr->max_restore_handle_count; i ++)
+        {
+            if (__atomic_load_n (&handle_mgr->restore_handles[i].handle_state, __ATOMIC_ACQUIRE) == HANDLE_STATE_FREE)
+            {
+                __atomic_store_n (&handle_mgr->restore_handles[i].handle_state, HANDLE_STATE_BEGINNING, __ATOMIC_RELEASE);
+                handle_mgr->restore_handles[i].is_registered = false;
+
+                handle = &handle_mgr->restore_handles[i];
+
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock (&handle_mgr->handle_mgr_mutex);
+
+    return handle;
+}
+
+static
+void release_handle_slot (HANDLE_TYPE handle_type, void* handle)
+{
+    pthread_mutex_lock (&handle_mgr->handle_mgr_mutex);
+
+    if (handle_type == BACKUP_HANDLE_TYPE)
+    {
+        ((BACKUP_HANDLE *)handle)->is_registered = false;
+        __atomic_store_n (&((BACKUP_HANDLE *)handle)->handle_state, HANDLE_STATE_FREE, __ATOMIC_RELEASE);
+    }
+    else if (handle_type == RESTORE_HANDLE_TYPE)
+    {
+        ((RESTORE_HANDLE *)handle)->is_registered = false;
+        __atomic_store_n (&((RESTORE_HANDLE *)handle)->handle_state, HANDLE_STATE_FREE, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock (&handle_mgr->handle_mgr_mutex);
+}
+
 int alloc_handle (HANDLE_TYPE handle_type, void** handle)
 {
     BACKUP_HANDLE* backup_handle;
@@ -169,16 +534,25 @@ int alloc_handle (HANDLE_TYPE handle_type, void** handle)
 
     if (handle_type == BACKUP_HANDLE_TYPE)
     {
-        backup_handle = &handle_mgr->backup_handle;
+        backup_handle = (BACKUP_HANDLE *)reserve_handle_slot (BACKUP_HANDLE_TYPE);
 
-        if (IS_FAILURE (pthread_mutex_trylock (&backup_handle->backup_mutex)))
+        if (IS_NULL (backup_handle))
         {
+            /* all slots are in use */
             PRINT_LOG_ERR (ERR_INFO);
             goto error;
         }
 
         state = 1;
 
+        if (IS_FAILURE (pthread_mutex_trylock (&backup_handle->backup_mutex)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        state = 2;
+
         if (IS_FAILURE (initialize_backup_handle (backup_handle)))
         {
             PRINT_LOG_ERR (ERR_INFO);
@@ -189,16 +563,25 @@ int alloc_handle (HANDLE_TYPE handle_type, void** handle)
     }
     else if (handle_type == RESTORE_HANDLE_TYPE)
     {
-        restore_handle = &handle_mgr->restore_handle;
+        restore_handle = (RESTORE_HANDLE *)reserve_handle_slot (RESTORE_HANDLE_TYPE);
 
-        if (IS_FAILURE (pthread_mutex_trylock (&restore_handle->restore_mutex)))
+        if (IS_NULL (restore_handle))
         {
+            /* all slots are in use */
             PRINT_LOG_ERR (ERR_INFO);
             goto error;
         }
 
         state = 1;
 
+        if (IS_FAILURE (pthread_mutex_trylock (&restore_handle->restore_mutex)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        state = 2;
+
         if (IS_FAILURE (initialize_restore_handle (restore_handle)))
         {
             PRINT_LOG_ERR (ERR_INFO);
@@ -214,7 +597,7 @@ error:
 
     switch (state)
     {
-        case 1:
+        case 2:
             if (handle_type == BACKUP_HANDLE_TYPE)
             {
                 pthread_mutex_unlock (&backup_handle->backup_mutex);
@@ -223,6 +606,15 @@ error:
             {
                 pthread_mutex_unlock (&restore_handle->restore_mutex);
             }
+        case 1:
+            if (handle_type == BACKUP_HANDLE_TYPE)
+            {
+                release_handle_slot (handle_type, backup_handle);
+            }
+            else if (handle_type == RESTORE_HANDLE_TYPE)
+            {
+                release_handle_slot (handle_type, restore_handle);
+            }
         default:
             break;
     }
@@ -230,6 +622,25 @@ error:
     return FAILURE;
 }
 
+static
+void bump_generation (unsigned int* generation)
+{
+    unsigned int next_generation;
+
+    next_generation = __atomic_load_n (generation, __ATOMIC_RELAXED) + 1;
+
+    if (next_generation == 0)
+    {
+        next_generation = 1;
+    }
+
+    __atomic_store_n (generation, next_generation, __ATOMIC_RELEASE);
+}
+
+/*
+ * free_handle () returns with the handle mutex unlocked
+ * and the slot given back to the handle table.
+ */
 int free_handle (HANDLE_TYPE handle_type, void* handle)
 {
     BACKUP_HANDLE* backup_handle;
@@ -258,11 +669,12 @@ int free_handle (HANDLE_TYPE handle_type, void* handle)
             goto error;
         }
 
-        if (IS_FAILURE (pthread_mutex_unlock (&backup_handle->backup_mutex)))
-        {
-            PRINT_LOG_ERR (ERR_INFO);
-            goto error;
-        }
+        bump_generation (&backup_handle->generation);
+
+        /* 이미 정리된 handle 이므로 여기서부터는 실패하지 않고 slot 을 돌려준다. */
+        pthread_mutex_unlock (&backup_handle->backup_mutex);
+
+        release_handle_slot (BACKUP_HANDLE_TYPE, backup_handle);
     }
     else if (handle_type == RESTORE_HANDLE_TYPE)
     {
@@ -284,11 +696,12 @@ int free_handle (HANDLE_TYPE handle_type, void* handle)
             goto error;
         }
 
-        if (IS_FAILURE (pthread_mutex_unlock (&restore_handle->restore_mutex)))
-        {
-            PRINT_LOG_ERR (ERR_INFO);
-            goto error;
-        }
+        bump_generation (&restore_handle->generation);
+
+        /* 이미 정리된 handle 이므로 여기서부터는 실패하지 않고 slot 을 돌려준다. */
+        pthread_mutex_unlock (&restore_handle->restore_mutex);
+
+        release_handle_slot (RESTORE_HANDLE_TYPE, restore_handle);
     }
 
     return SUCCESS;
@@ -313,30 +726,193 @@ error:
     return FAILURE;
 }
 
-int validate_handle (HANDLE_TYPE handle_type, void* handle)
+/*
+ * register_handle () reserves the target of a handle
+ * (db_name for backup, restore file or db_name of RESTORE_TO_DB for restore)
+ * so that two live sessions never share the same fifo or restore file.
+ */
+int register_handle (HANDLE_TYPE handle_type, void* handle)
 {
     BACKUP_HANDLE* backup_handle;
+    BACKUP_HANDLE* other_backup_handle;
     RESTORE_HANDLE* restore_handle;
+    RESTORE_HANDLE* other_restore_handle;
+
+    int i;
+    int state = 0;
+
+    if (IS_FAILURE (pthread_mutex_lock (&handle_mgr->handle_mgr_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    if (handle_type == BACKUP_HANDLE_TYPE)
+    {
+        backup_handle = (BACKUP_HANDLE *)handle;
+
+        for (i = 0; i < handle_mgr->max_backup_handle_count; i ++)
+        {
+            other_backup_handle = &handle_mgr->backup_handles[i];
+
+            if (other_backup_handle == backup_handle || other_backup_handle->is_registered == false)
+            {
+                continue;
+            }
+
+            if (IS_ZERO (strcmp (other_backup_handle->db_name, backup_handle->db_name)))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
+            }
+        }
+
+        backup_handle->is_registered = true;
+    }
+    else if (handle_type == RESTORE_HANDLE_TYPE)
+    {
+        restore_handle = (RESTORE_HANDLE *)handle;
+
+        for (i = 0; i < handle_mgr->max_restore_handle_count; i ++)
+        {
+            other_restore_handle = &handle_mgr->restore_handles[i];
+
+            if (other_restore_handle == restore_handle || other_restore_handle->is_registered == false)
+            {
+                continue;
+            }
+
+            /* cubrid restoredb 는 database 마다 하나만 수행할 수 있다. */
+            if (restore_handle->restore_type == RESTORE_TO_DB &&
+                other_restore_handle->restore_type == RESTORE_TO_DB &&
+                IS_ZERO (strcmp (other_restore_handle->db_name, restore_handle->db_name)))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
+            }
+
+            if (other_restore_handle->backup_level == restore_handle->backup_level &&
+                IS_ZERO (strcmp (other_restore_handle->db_name, restore_handle->db_name)) &&
+                IS_ZERO (strcmp (other_restore_handle->backup_file_path, restore_handle->backup_file_path)))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                goto error;
+            }
+        }
+
+        restore_handle->is_registered = true;
+    }
+
+    pthread_mutex_unlock (&handle_mgr->handle_mgr_mutex);
+
+    return SUCCESS;
 
+error:
+
+    switch (state)
+    {
+        case 1:
+            pthread_mutex_unlock (&handle_mgr->handle_mgr_mutex);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+static
+HANDLE_STATE* get_handle_state (HANDLE_TYPE handle_type, void* handle)
+{
     if (handle_type == BACKUP_HANDLE_TYPE)
     {
-        backup_handle = &handle_mgr->backup_handle;
+        return &((BACKUP_HANDLE *)handle)->handle_state;
+    }
+    else
+    {
+        return &((RESTORE_HANDLE *)handle)->handle_state;
+    }
+}
+
+void* get_handle_id (HANDLE_TYPE handle_type, void* handle)
+{
+    HANDLE_ID handle_id;
+    unsigned int generation;
+    int slot_index;
 
-        if (backup_handle != handle)
+    if (handle_type == BACKUP_HANDLE_TYPE)
+    {
+        generation = __atomic_load_n (&((BACKUP_HANDLE *)handle)->generation, __ATOMIC_ACQUIRE);
+        slot_index = ((BACKUP_HANDLE *)handle)->slot_index;
+    }
+    else
+    {
+        generation = __atomic_load_n (&((RESTORE_HANDLE *)handle)->generation, __ATOMIC_ACQUIRE);
+        slot_index = ((RESTORE_HANDLE *)handle)->slot_index;
+    }
+
+    handle_id = ((HANDLE_ID)generation << (HANDLE_ID_TYPE_BITS + HANDLE_ID_SLOT_BITS)) |
+                ((HANDLE_ID)handle_type << HANDLE_ID_SLOT_BITS) |
+                (HANDLE_ID)slot_index;
+
+    return (void *)(uintptr_t)handle_id;
+}
+
+/*
+ * validate_handle () resolves a handle id to its slot without any lock.
+ * the caller has to validate it again after locking the handle mutex,
+ * since the slot can be freed and reused in the meantime.
+ */
+int validate_handle (HANDLE_TYPE handle_type, void* id, void** handle)
+{
+    HANDLE_ID handle_id;
+    unsigned int generation;
+    unsigned int slot_index;
+
+    handle_id = (HANDLE_ID)(uintptr_t)id;
+
+    generation = (unsigned int)(handle_id >> (HANDLE_ID_TYPE_BITS + HANDLE_ID_SLOT_BITS));
+    slot_index = (unsigned int)(handle_id & (MAX_HANDLE_SLOT_COUNT - 1));
+
+    if (IS_ZERO (generation) ||
+        ((handle_id >> HANDLE_ID_SLOT_BITS) & ((1 << HANDLE_ID_TYPE_BITS) - 1)) != (HANDLE_ID)handle_type)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (handle_type == BACKUP_HANDLE_TYPE)
+    {
+        if (IS_NULL (handle_mgr->backup_handles) || slot_index >= handle_mgr->max_backup_handle_count)
         {
             PRINT_LOG_ERR (ERR_INFO);
             goto error;
         }
+
+        *handle = &handle_mgr->backup_handles[slot_index];
     }
     else if (handle_type == RESTORE_HANDLE_TYPE)
     {
-        restore_handle = &handle_mgr->restore_handle;
-
-        if (restore_handle != handle)
+        if (IS_NULL (handle_mgr->restore_handles) || slot_index >= handle_mgr->max_restore_handle_count)
         {
             PRINT_LOG_ERR (ERR_INFO);
             goto error;
         }
+
+        *handle = &handle_mgr->restore_handles[slot_index];
+    }
+    else
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (get_handle_id (handle_type, *handle) != id ||
+        __atomic_load_n (get_handle_state (handle_type, *handle), __ATOMIC_ACQUIRE) == HANDLE_STATE_FREE)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
     }
 
     return SUCCESS;
@@ -346,13 +922,25 @@ error:
     return FAILURE;
 }
 
-int set_thread_state (HANDLE_TYPE handle_type, void* handle, THREAD_STATE state_where)
+int check_handle_state (HANDLE_TYPE handle_type, void* handle, HANDLE_STATE state_now)
 {
-    if (handle_type == BACKUP_HANDLE_TYPE)
+    if (__atomic_load_n (get_handle_state (handle_type, handle), __ATOMIC_ACQUIRE) != state_now)
     {
-        ((BACKUP_HANDLE *)handle)->backup_thread_state = state_where;
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
     }
-    else
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int transit_handle_state (HANDLE_TYPE handle_type, void* handle, HANDLE_STATE state_now, HANDLE_STATE state_where)
+{
+    if (!__atomic_compare_exchange_n (get_handle_state (handle_type, handle), &state_now, state_where,
+                                      false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
     {
         PRINT_LOG_ERR (ERR_INFO);
         goto error;
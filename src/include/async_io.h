@@ -0,0 +1,59 @@
+#ifndef _ASYNC_IO_H_
+#define _ASYNC_IO_H_
+
+#include <pthread.h>
+#include "backup_api.h"
+#include "handle_manager.h"
+
+/* buffers in flight (submitted but not reaped yet) per handle */
+#define MAX_ASYNC_IO_DEPTH (64)
+
+typedef struct async_io_entry ASYNC_IO_ENTRY;
+struct async_io_entry
+{
+    void* buffer;
+    unsigned int buffer_size; /* read: size of the buffer, write: length of the data */
+    unsigned int data_len;    /* bytes read or written */
+    int backup_level;         /* write only */
+    int result;
+    void* user_data;
+};
+
+/* serves one submission on the worker thread and returns its result */
+typedef int (*ASYNC_IO_FUNC) (void* handle, ASYNC_IO_ENTRY* entry);
+
+/*
+ * submission queue (sq) and completion queue (cq) of a backup/restore handle
+ *
+ * 둘 다 single-producer/single-consumer ring 이며 head, tail 은 계속 증가만 한다.
+ * - sq: submit 하는 thread 가 head 를, worker thread 가 tail 을 쓴다.
+ * - cq: worker thread 가 head 를, reap 하는 thread 가 tail 을 쓴다.
+ * sq_head - cq_tail 이 MAX_ASYNC_IO_DEPTH 를 넘지 않도록 submit 을 막으므로 두 ring 모두 넘치지 않는다.
+ */
+struct async_io
+{
+    pthread_t worker_thread;
+
+    void* handle;
+    ASYNC_IO_FUNC io_func;
+
+    ASYNC_IO_ENTRY sq[MAX_ASYNC_IO_DEPTH];
+    ASYNC_IO_ENTRY cq[MAX_ASYNC_IO_DEPTH];
+
+    unsigned long long sq_head; /* accessed atomically */
+    unsigned long long sq_tail; /* accessed atomically */
+    unsigned long long cq_head; /* accessed atomically */
+    unsigned long long cq_tail; /* accessed atomically */
+
+    int sq_event_fd; /* submitter -> worker thread, sq is no longer empty (or stop) */
+    int cq_event_fd; /* worker thread -> reaper, cq is no longer empty */
+
+    bool is_stop; /* accessed atomically */
+};
+
+int start_async_io (void*, ASYNC_IO_FUNC, ASYNC_IO**);
+void stop_async_io (ASYNC_IO**);
+int submit_async_io (ASYNC_IO*, ASYNC_IO_ENTRY*);
+int reap_async_io (ASYNC_IO*, CUBRID_IO_COMPLETION*, unsigned int, int, unsigned int*);
+
+#endif
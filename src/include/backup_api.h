@@ -12,6 +12,15 @@ struct cubrid_backup_info
     const char* db_name;
 };
 
+/*
+ * RESTORE_TO_DB runs cubrid restoredb on a fifo (<db>_bk<level>v000 in a new directory
+ * <backup_file_path>/<db>_restore.XXXXXX, backup_home if backup_file_path is NULL) and streams
+ * what cubrid_restore_write () is given into it, so the backup file is never written to disk.
+ * cubrid_restore_end () closes the fifo, removes it with its directory,
+ * waits for restoredb to finish and fails if it exited with an error.
+ * Progress and the exit status are written to the log. Only cubrid_restore_write () and
+ * volume 0 of cubrid_restore_write_volume () are supported on such a session.
+ */
 typedef enum restore_type RESTORE_TYPE;
 enum restore_type
 {
@@ -19,12 +28,21 @@ enum restore_type
     RESTORE_TO_FILE
 };
 
+/*
+ * backup_level of a restore session that accepts levels 0, 1 and 2 at once.
+ * Each level is written to its own file through its own session, begun on its first write,
+ * so different levels may be written from different threads at the same time.
+ * Such a session takes up to 4 restore handles (max_handle_count) and supports
+ * cubrid_restore_write () and cubrid_restore_write_volume () only.
+ */
+#define CUBRID_RESTORE_ALL_LEVELS (-1)
+
 typedef struct cubrid_restore_info CUBRID_RESTORE_INFO;
 struct cubrid_restore_info
 {
     RESTORE_TYPE restore_type;
     int backup_level;
-    const char* up_to_date; /* format: dd-mm-yyyy:hh:mm:ss */
+    const char* up_to_date; /* format: dd-mm-yyyy:hh:mm:ss, RESTORE_TO_DB only, NULL: latest */
     const char* backup_file_path;
     const char* db_name;
 };
@@ -36,13 +54,198 @@ int cubrid_backup_read (void* backup_handle,
                         void* buffer,
                         unsigned int buffer_size,
                         unsigned int* data_len);
+/*
+ * Same as cubrid_backup_read (), but waits at most timeout_msecs in total for backup data
+ * and returns whatever has been collected by then (data_len may be 0).
+ * timeout_msecs: -1 uses read_timeout_msecs of cubrid_backup.conf (where 0 means no deadline),
+ * 0 does not wait.
+ */
+int cubrid_backup_read_with_timeout (void* backup_handle,
+                                     void* buffer,
+                                     unsigned int buffer_size,
+                                     unsigned int* data_len,
+                                     int timeout_msecs);
+/*
+ * Moves up to max_bytes of backup data straight into out_fd (file, pipe or socket)
+ * without copying it through a user buffer. out_fd should be a blocking descriptor.
+ * Returns the same values as cubrid_backup_read ().
+ */
+int cubrid_backup_read_to_fd (void* backup_handle,
+                              int out_fd,
+                              unsigned int max_bytes,
+                              unsigned int* moved);
+/*
+ * Asks cubrid backupdb to stop and returns without waiting for it.
+ * A blocked cubrid_backup_read () then fails, and cubrid_backup_end () must still be called.
+ */
+int cubrid_backup_cancel (void* backup_handle);
+/*
+ * Makes every later read on this handle fill at least read_lowat bytes (or the whole buffer,
+ * if smaller) before returning, like SO_RCVLOWAT. 0 restores the default behavior.
+ * A shorter chunk is returned only at the end of the backup, when cubrid backupdb closes
+ * the fifo, or when the timeout of cubrid_backup_read_with_timeout () expires.
+ */
+int cubrid_backup_set_read_lowat (void* backup_handle, unsigned int read_lowat);
+/*
+ * Sets the capacity of the backup fifo of this handle in bytes, 0 restores [backup] pipe_size
+ * of cubrid_backup.conf. Call it before the first read. Fails if the kernel refuses the size
+ * (see /proc/sys/fs/pipe-max-size), and the backup goes on with the pipe it has.
+ */
+int cubrid_backup_set_pipe_size (void* backup_handle, int pipe_size);
+/*
+ * Called by cubrid_backup_run () with each chunk of backup data, in order.
+ * Return 0 to go on, anything else to stop the backup.
+ */
+typedef int (*CUBRID_BACKUP_SINK) (void* ctx, const void* data, unsigned int data_len);
+/*
+ * Reads the whole backup and hands it to sink_cb on the calling thread.
+ * An internal thread fills one of nbuffers (2 ~ 64) buffers of buffer_size bytes
+ * while sink_cb processes another, so every chunk but the last is buffer_size bytes.
+ * Returns 0 after the last chunk, -1 on error or when sink_cb stopped the backup.
+ * cubrid_backup_end () must still be called. Do not read the handle from other threads meanwhile.
+ */
+int cubrid_backup_run (void* backup_handle,
+                       CUBRID_BACKUP_SINK sink_cb,
+                       void* ctx,
+                       unsigned int buffer_size,
+                       unsigned int nbuffers);
+/*
+ * Returns a descriptor that becomes readable when cubrid_backup_read_nb () should be called
+ * again (data, end of backup or an error), for poll/epoll/select based event loops.
+ * It is owned by the handle and closed by cubrid_backup_end (). Returns -1 on error.
+ */
+int cubrid_backup_get_pollfd (void* backup_handle);
+/*
+ * Never waits: reads what is available now, up to buffer_size bytes.
+ * Returns 1 with *data_len > 0, 2 when nothing can be read yet, 0 at the end of the backup,
+ * -1 on error. Keep calling it until it returns 2 before waiting on the poll fd again.
+ */
+int cubrid_backup_read_nb (void* backup_handle,
+                           void* buffer,
+                           unsigned int buffer_size,
+                           unsigned int* data_len);
+/*
+ * A buffer posted by cubrid_backup_submit_read () or cubrid_restore_submit_write (), once done.
+ * result is what cubrid_backup_read () or cubrid_restore_write () would have returned.
+ */
+typedef struct cubrid_io_completion CUBRID_IO_COMPLETION;
+struct cubrid_io_completion
+{
+    void* buffer;
+    void* user_data;
+    unsigned int data_len; /* bytes read or written */
+    int result;
+};
+/*
+ * Posts a buffer to be filled like cubrid_backup_read () and returns at once.
+ * Buffers are filled one at a time in the order they were posted, by a single internal thread
+ * of the handle: posting overlaps the I/O with the caller's work, not one I/O with another.
+ * Returns 0, 2 when 64 buffers are already in flight (reap some first), -1 on error.
+ * Once used, the other read functions fail on this handle.
+ */
+int cubrid_backup_submit_read (void* backup_handle,
+                               void* buffer,
+                               unsigned int buffer_size,
+                               void* user_data);
+/*
+ * Takes up to max_count filled buffers, in order. timeout_msecs: -1 waits for at least one,
+ * 0 does not wait. Returns the number of completions (0 if nothing is in flight), -1 on error.
+ * Submit from one thread and reap from one thread at a time. Buffers still in flight
+ * at cubrid_backup_end () are dropped.
+ */
+int cubrid_backup_reap (void* backup_handle,
+                        CUBRID_IO_COMPLETION* completions,
+                        unsigned int max_count,
+                        int timeout_msecs);
 int cubrid_backup_end (void* backup_handle);
 
 int cubrid_restore_begin (CUBRID_RESTORE_INFO* restore_info, void** restore_handle);
+/*
+ * Same as cubrid_restore_begin (), but begins a resumable session (RESTORE_TO_FILE, one backup_level),
+ * see cubrid_restore_get_resume_offset ().
+ */
+int cubrid_restore_begin_resumable (CUBRID_RESTORE_INFO* restore_info, void** restore_handle);
 int cubrid_restore_write (void* restore_handle,
                           int backup_level,
                           void* buffer,
                           unsigned int data_len);
+/*
+ * Writes one volume of a multi-volume backup (<db>_bk<level>v<NNN>, volume_index < 64).
+ * Volume 0 is the same as cubrid_restore_write (). The other volumes are opened on their
+ * first write, each with its own descriptor, so different volumes may be written from
+ * different threads at the same time. Writes to one volume must come in order.
+ */
+int cubrid_restore_write_volume (void* restore_handle,
+                                 int backup_level,
+                                 int volume_index,
+                                 void* buffer,
+                                 unsigned int data_len);
+/*
+ * Writes data_len bytes at offset of the restore file (RESTORE_TO_FILE, volume 0), so that
+ * ranges fetched in parallel can be written from many threads at once, in any order.
+ * The first call turns the session into positional mode, where the other write functions fail;
+ * it must come before any of them. Ranges may be written again, but cubrid_restore_end ()
+ * fails unless the written ranges cover the file from offset 0 without a gap
+ * (up to the size given to cubrid_restore_set_expected_size (), if any).
+ */
+int cubrid_restore_pwrite (void* restore_handle,
+                           int backup_level,
+                           long long offset,
+                           void* buffer,
+                           unsigned int data_len);
+/*
+ * A session begun by cubrid_restore_begin_resumable () makes the restore file
+ * durable every [restore] checkpoint_size and records the offset in <db>_bk<level>v000.ckpt.
+ * If a session fails or the process dies, the next resumable session of the same file
+ * (same db_name and backup_level) keeps the data up to the last checkpoint
+ * instead of truncating it, and this returns that offset: continue with cubrid_restore_write ()
+ * from there. Returns 0 for a fresh start, -1 on error.
+ * cubrid_restore_end () before the expected size bytes checkpoints what was written;
+ * otherwise a successful cubrid_restore_end () removes the checkpoint.
+ * Not supported with cubrid_restore_pwrite () and volumes other than 0.
+ */
+long long cubrid_restore_get_resume_offset (void* restore_handle);
+/*
+ * Tells the size of the restore file (RESTORE_TO_FILE, not CUBRID_RESTORE_ALL_LEVELS) in bytes,
+ * which is preallocated up front; 0 means unknown. Call it before the first write of the session.
+ * A resumed session keeps the size recorded in the checkpoint and fails for a different one;
+ * cubrid_restore_begin () starts the file over.
+ */
+int cubrid_restore_set_expected_size (void* restore_handle, long long expected_size);
+/*
+ * Returns a descriptor that becomes readable when cubrid_restore_write_nb () can make progress.
+ * It is an eventfd that can be added to epoll; it is owned by the handle and must not be closed
+ * or read. Returns -1 on error.
+ */
+int cubrid_restore_get_pollfd (void* restore_handle);
+/*
+ * Writes at most data_len bytes without waiting and stores the count in *written,
+ * which may be short. Returns 0 on progress, 2 when nothing could be written yet, -1 on error.
+ * It only avoids waiting for the disk with [restore] write_queue_depth > 0, where the data is
+ * queued for the restore writer. With write_queue_depth=0 it is a plain write () of the restore
+ * file, which blocks like cubrid_restore_write (), and the pollfd is always readable.
+ */
+int cubrid_restore_write_nb (void* restore_handle,
+                             int backup_level,
+                             void* buffer,
+                             unsigned int data_len,
+                             unsigned int* written);
+/*
+ * Posts data to be written like cubrid_restore_write () and returns at once.
+ * The same rules as cubrid_backup_submit_read () apply, and the buffer must stay
+ * untouched until it is reaped by cubrid_restore_reap ().
+ * One thread per handle writes the posted buffers in order, so only one write is in flight
+ * unless [restore] write_queue_depth > 1 lets that thread queue several on the restore writer.
+ */
+int cubrid_restore_submit_write (void* restore_handle,
+                                 int backup_level,
+                                 void* buffer,
+                                 unsigned int data_len,
+                                 void* user_data);
+int cubrid_restore_reap (void* restore_handle,
+                         CUBRID_IO_COMPLETION* completions,
+                         unsigned int max_count,
+                         int timeout_msecs);
 int cubrid_restore_end (void* restore_handle);
 
 int cubrid_backup_finalize (void);
@@ -3,6 +3,7 @@
 
 #include <unistd.h>
 
+#define SUCCESS_WOULDBLOCK (2) // non-blocking 호출 시 지금은 읽을 (쓸) 수 없음을 의미
 #define SUCCESS_FRAGMENTED (1) // cubrid_backup_read () 시 읽을 데이터가 남아 있음을 의미
 #define SUCCESS            (0)
 #define FAILURE            (-1)
@@ -11,6 +12,7 @@
 #define IS_FAILURE(a) ((a) != SUCCESS)
 
 #define IS_NULL(a) ((a) == NULL)
+#define IS_NOT_NULL(a) ((a) != NULL)
 
 #define IS_ZERO(a) ((a) == 0)
 #define IS_NOT_ZERO(a) ((a) != 0)
@@ -11,11 +11,12 @@ enum backup_api_state
     BACKUP_API_STATE_NOT_READY,
     BACKUP_API_STATE_INITIALIZING,
     BACKUP_API_STATE_READY,
-    BACKUP_API_STATE_BACKUP_SERVICE,
-    BACKUP_API_STATE_RESTORE_SERVICE,
     BACKUP_API_STATE_FINALIZING
 };
 
+/* cubrid_backup_run () */
+#define MAX_BACKUP_RUN_BUFFER_COUNT (64)
+
 typedef enum func_call FUNC_CALL;
 enum func_call
 {
@@ -24,9 +25,17 @@ enum func_call
     FUNC_CALL_BACKUP_BEGIN,
     FUNC_CALL_BACKUP_END,
     FUNC_CALL_BACKUP_READ,
+    FUNC_CALL_BACKUP_CANCEL,
+    FUNC_CALL_BACKUP_SET_READ_LOWAT,
+    FUNC_CALL_BACKUP_SET_PIPE_SIZE,
+    FUNC_CALL_BACKUP_RUN,
+    FUNC_CALL_BACKUP_GET_POLLFD,
     FUNC_CALL_RESTORE_BEGIN,
     FUNC_CALL_RESTORE_END,
-    FUNC_CALL_RESTORE_WRITE
+    FUNC_CALL_RESTORE_WRITE,
+    FUNC_CALL_RESTORE_GET_POLLFD,
+    FUNC_CALL_RESTORE_GET_RESUME_OFFSET,
+    FUNC_CALL_RESTORE_SET_EXPECTED_SIZE
 };
 
 extern pthread_once_t backup_api_once_initialize;
@@ -37,10 +46,26 @@ void finalize_backup_api (void);
 int check_api_call_sequence (FUNC_CALL);
 int transit_backup_api_state (BACKUP_API_STATE, BACKUP_API_STATE);
 int begin_backup (CUBRID_BACKUP_INFO*, void**);
-int end_backup (BACKUP_HANDLE*);
-int begin_restore (CUBRID_RESTORE_INFO*, void**);
-int end_restore (RESTORE_HANDLE*);
-int read_backup_data (BACKUP_HANDLE*, void*, unsigned int, unsigned int*, bool*);
-int write_backup_data (RESTORE_HANDLE*, int, void*, unsigned int);
+int end_backup (void*);
+int cancel_backup (void*);
+int set_read_lowat (void*, unsigned int);
+int set_backup_pipe_size (void*, int);
+int get_backup_pollfd (void*, int*);
+int begin_restore (CUBRID_RESTORE_INFO*, bool, void**);
+int end_restore (void*);
+int read_backup_data (void*, void*, unsigned int, unsigned int*, int, bool*);
+int read_backup_data_to_fd (void*, int, unsigned int, unsigned int*, bool*);
+int run_backup (void*, CUBRID_BACKUP_SINK, void*, unsigned int, unsigned int);
+int submit_backup_read (void*, void*, unsigned int, void*);
+int reap_backup_data (void*, CUBRID_IO_COMPLETION*, unsigned int, int, unsigned int*);
+int write_backup_data (void*, int, void*, unsigned int);
+int write_backup_volume_data (void*, int, int, void*, unsigned int);
+int pwrite_backup_data (void*, int, long long, void*, unsigned int);
+int get_restore_pollfd (void*, int*);
+int get_resume_offset (void*, long long*);
+int set_expected_size (void*, long long);
+int write_backup_data_nb (void*, int, void*, unsigned int, unsigned int*);
+int submit_backup_write (void*, int, void*, unsigned int, void*);
+int reap_restore_data (void*, CUBRID_IO_COMPLETION*, unsigned int, int, unsigned int*);
 
 #endif
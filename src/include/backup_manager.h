@@ -11,6 +11,25 @@
 
 #define ERR_INFO "in %s () at %s:%d\n", __func__, __FILE__, __LINE__
 
+#define DEFAULT_MAX_HANDLE_COUNT (16)
+
+#define DEFAULT_READ_TIMEOUT_MSECS (2000)
+
+/* read-ahead ring used when only spill_size is configured */
+#define DEFAULT_SPILL_RING_SIZE (1024 * 1024)
+
+/* upper limit of write_queue_depth, must not exceed MAX_ASYNC_IO_DEPTH (see restore_writer.c) */
+#define MAX_WRITE_QUEUE_DEPTH (64)
+
+/* O_DIRECT restore writes are aligned to this (file offset, length and memory) */
+#define DIRECT_IO_ALIGN (4096)
+
+/* staging buffers of the restore writer when only direct_io_size is configured */
+#define DEFAULT_DIRECT_IO_QUEUE_DEPTH (4)
+
+/* checkpoint interval of a resumable restore session */
+#define DEFAULT_CHECKPOINT_SIZE (1024LL * 1024 * 1024)
+
 #define PRINT_LOG_INFO(...) \
     print_log ("INFO:", __VA_ARGS__)
 #define PRINT_LOG_ERR(...) \
@@ -26,6 +45,11 @@ struct backup_option
     bool compress;
     bool except_active_log;
     int sleep_msecs;
+    int pipe_size; /* capacity of the backup fifo, 0: kernel default */
+    int max_handle_count; /* concurrent backup sessions */
+    int read_timeout_msecs; /* max wait of cubrid_backup_read () for backup data, 0: no deadline */
+    int read_ahead_size; /* ring of the prefetch thread, 0: no read-ahead */
+    long long spill_size; /* scratch file under backup_home behind the ring, 0: no spill */
 };
 
 typedef struct restore_option RESTORE_OPTION;
@@ -33,6 +57,11 @@ struct restore_option
 {
     bool partial_recovery;
     bool use_database_location_path;
+    int max_handle_count; /* concurrent restore sessions */
+    int write_queue_depth; /* writes in flight on the restore file, 0: one write () at a time, also for cubrid_restore_submit_write () */
+    int direct_io_size; /* O_DIRECT extent of the restore file, 0: buffered writes */
+    int writeback_size; /* window of sync_file_range () on buffered restore writes, 0: left to the kernel */
+    long long checkpoint_size; /* fdatasync () and checkpoint interval of a resumable restore session */
 };
 
 typedef struct backup_manager BACKUP_MANAGER;
@@ -55,6 +84,8 @@ int start_backup_manager (void);
 int stop_backup_manager (void);
 int validate_dir (const char*);
 int check_path_length_limit (const char*);
+void signal_event_fd (int);
+void drain_event_fd (int);
 
 int print_log (const char *prefix_str, const char *msg, ...);
 #endif
@@ -3,11 +3,32 @@
 
 #include <pthread.h>
 #include <signal.h>
+#include <stdint.h>
+#include <time.h>
 #include "backup_manager.h"
 
 /* The maximum length of database name is 17 in English. */
 #define MAX_DB_NAME_LEN 17
 
+/*
+ * handle id returned to the application as an opaque (void *)
+ *
+ *  63               32 31         24 23                0
+ * +-------------------+-------------+-------------------+
+ * |    generation     | handle type |    slot index     |
+ * +-------------------+-------------+-------------------+
+ *
+ * generation of a slot is bumped whenever the slot is freed,
+ * so a stale id of a recycled slot never validates.
+ */
+typedef uint64_t HANDLE_ID;
+
+#define HANDLE_ID_SLOT_BITS       (24)
+#define HANDLE_ID_TYPE_BITS       (8)
+#define HANDLE_ID_GENERATION_BITS (32)
+
+#define MAX_HANDLE_SLOT_COUNT (1 << HANDLE_ID_SLOT_BITS)
+
 typedef enum handle_type HANDLE_TYPE;
 enum handle_type
 {
@@ -15,13 +36,28 @@ enum handle_type
     RESTORE_HANDLE_TYPE
 };
 
-typedef enum thread_state THREAD_STATE;
-enum thread_state
+/*
+ * session state of a backup/restore handle
+ *
+ * FREE -> BEGINNING -> IN_SERVICE -> ENDING -> FREE
+ */
+typedef enum handle_state HANDLE_STATE;
+enum handle_state
+{
+    HANDLE_STATE_FREE,       /* slot is not allocated */
+    HANDLE_STATE_BEGINNING,  /* cubrid_backup_begin () / cubrid_restore_begin () */
+    HANDLE_STATE_IN_SERVICE, /* read/write is allowed */
+    HANDLE_STATE_ENDING      /* cubrid_backup_end () / cubrid_restore_end () */
+};
+
+/* state of the backup process (cubrid backupdb), see process_manager.c */
+typedef enum process_state PROCESS_STATE;
+enum process_state
 {
-    THREAD_STATE_NO_SPAWN,
-    THREAD_STATE_RUNNING,
-    THREAD_STATE_EXIT,
-    THREAD_STATE_EXIT_WITH_ERROR
+    PROCESS_STATE_NO_SPAWN,
+    PROCESS_STATE_RUNNING,
+    PROCESS_STATE_EXIT,
+    PROCESS_STATE_EXIT_WITH_ERROR
 };
 
 typedef enum backup_level BACKUP_LEVEL;
@@ -32,15 +68,52 @@ enum backup_level
     BACKUP_SMALL_INCREMENT_LEVEL
 };
 
+typedef struct backup_stat BACKUP_STAT;
+struct backup_stat
+{
+    unsigned long long read_bytes;
+    unsigned long long read_syscall_count; /* read () + poll () */
+    unsigned long long read_call_count;    /* cubrid_backup_read () that returned data */
+    unsigned long long read_timeout_count; /* cubrid_backup_read () returned at the deadline */
+    unsigned long long ring_full_count;    /* read-ahead ring filled up before the reader caught up */
+    unsigned long long spill_high_water;   /* max bytes held in the spill file at once */
+    unsigned long long spill_bytes;        /* bytes that went through the spill file */
+    long long launch_usecs;                /* posix_spawn () of cubrid backupdb */
+    struct timespec launch_time;
+    long long process_msecs;               /* launch -> cubrid backupdb exited */
+    long long reader_msecs;                /* launch -> cubrid_backup_read () returned the end of backup */
+};
+
+/* see read_ahead.h */
+typedef struct read_ahead READ_AHEAD;
+
+/* see async_io.h */
+typedef struct async_io ASYNC_IO;
+
+/* see restore_writer.h */
+typedef struct restore_writer RESTORE_WRITER;
+
 typedef struct backup_handle BACKUP_HANDLE;
 struct backup_handle
 {
-    pthread_t backup_thread;
+    HANDLE_STATE handle_state; /* accessed atomically */
+    bool is_registered;        /* db_name is reserved, protected by handle_mgr_mutex */
+    unsigned int generation;   /* bumped on free, accessed atomically */
+    int slot_index;
+
     pthread_mutex_t backup_mutex;
 
-    THREAD_STATE backup_thread_state;
+    PROCESS_STATE backup_process_state; /* accessed atomically */
+
+    int cancel_fd; /* eventfd, signaled by cancel_backup_process () */
+    int exit_fd;   /* eventfd, signaled when the backup process is reaped */
 
+    /* protected by process_mgr_mutex */
+    pid_t backup_pid;
+    int pid_fd;
     bool is_cancel;
+    int kill_signal;               /* last signal sent to the backup process */
+    struct timespec kill_time;
 
     BACKUP_LEVEL backup_level;
     bool remove_archive;
@@ -49,14 +122,62 @@ struct backup_handle
     bool compress;
 
     int fifo_fd;
+    int pipe_size;
     char fifo_path[PATH_MAX];
 
+    unsigned int read_lowat; /* 0: return as soon as any data is read */
+
+    READ_AHEAD* read_ahead; /* NULL: cubrid_backup_read () reads the fifo directly */
+
+    int poll_fd; /* epoll returned by cubrid_backup_get_pollfd (), -1: not requested */
+
+    ASYNC_IO* async_io; /* set by the first cubrid_backup_submit_read (), accessed atomically */
+
     char db_name[MAX_DB_NAME_LEN + 1];
+
+    BACKUP_STAT backup_stat;
+};
+
+typedef struct restore_stat RESTORE_STAT;
+struct restore_stat
+{
+    struct timespec launch_time; /* posix_spawn () of cubrid restoredb */
+    long long progress_offset;   /* write_offset at the last progress log */
+};
+
+/* [start, end) of the restore file written by cubrid_restore_pwrite () */
+typedef struct restore_range RESTORE_RANGE;
+struct restore_range
+{
+    long long start;
+    long long end;
+};
+
+/* initial capacity of the range map, doubled as needed */
+#define DEFAULT_RESTORE_RANGE_COUNT (64)
+
+/* v000 is restore_fd, v001 ~ are opened by cubrid_restore_write_volume () */
+#define MAX_RESTORE_VOLUME_COUNT (64)
+
+/*
+ * volume_mutex 는 handle 과 함께 한 번만 초기화되고, 해당 volume 에 write 하는 동안 잡는다.
+ * restore_mutex 없이 volume 별로 동시에 write 할 수 있다.
+ */
+typedef struct restore_volume RESTORE_VOLUME;
+struct restore_volume
+{
+    pthread_mutex_t volume_mutex;
+    int volume_fd; /* -1: not opened yet */
 };
 
 typedef struct restore_handle RESTORE_HANDLE;
 struct restore_handle
 {
+    HANDLE_STATE handle_state; /* accessed atomically */
+    bool is_registered;        /* restore target is reserved, protected by handle_mgr_mutex */
+    unsigned int generation;   /* bumped on free, accessed atomically */
+    int slot_index;
+
     pthread_mutex_t restore_mutex;
 
     int restore_type;
@@ -66,14 +187,58 @@ struct restore_handle
     int restore_fd;
     char backup_file_path[PATH_MAX];
 
+    ASYNC_IO* async_io; /* set by the first cubrid_restore_submit_write (), accessed atomically */
+
+    RESTORE_WRITER* restore_writer; /* NULL: write () each buffer before returning */
+
+    int event_fd; /* without restore_writer, handed out by cubrid_restore_get_pollfd (), -1: not created yet */
+
+    /* RESTORE_TO_DB: cubrid restoredb reads the backup data from the fifo */
+    pid_t restore_pid; /* -1: not spawned or already reaped */
+    int fifo_fd;
+    char fifo_path[PATH_MAX];
+
+    RESTORE_VOLUME volumes[MAX_RESTORE_VOLUME_COUNT]; /* [0] is not used */
+
+    /*
+     * cubrid_restore_pwrite (): 쓰는 동안 pwrite_lock 을 shared 로 잡고, restore_fd 를 닫기 전에는
+     * exclusive 로 잡아서 끝나지 않은 pwrite () 를 기다린다. pwrite 는 pwrite_lock 을 잡은 뒤에 handle 이
+     * IN_SERVICE 일 때만 restore_mutex 를 잡는다. (free_handle () 은 restore_mutex 를 잡은 채 exclusive 로 잡는다.)
+     * range map 은 restore_mutex 로 보호하며, 이웃한 구간은 합쳐서 start 순으로 둔다.
+     */
+    pthread_rwlock_t pwrite_lock;
+    bool is_positional; /* set by the first cubrid_restore_pwrite (), the sequential writes fail */
+    RESTORE_RANGE* ranges;
+    int range_count;
+    int range_capacity;
+
+    /* CUBRID_RESTORE_ALL_LEVELS: ids of the session of each level, NULL: not begun yet */
+    void* level_handles[BACKUP_SMALL_INCREMENT_LEVEL + 1];
+
+    long long expected_size;    /* CUBRID_RESTORE_INFO, 0: not preallocated */
+    long long write_offset;     /* bytes handed to restore_fd so far */
+    long long writeback_offset; /* writeback of restore_fd is started up to here, see [restore] writeback_size */
+
+    /* cubrid_restore_begin_resumable (): restore_fd is durable up to checkpoint_offset, see <db>_bk<level>v000.ckpt */
+    bool is_resumable;
+    long long resume_offset;     /* checkpoint_offset kept from a previous session at cubrid_restore_begin () */
+    long long checkpoint_offset;
+
     char db_name[MAX_DB_NAME_LEN + 1];
+
+    RESTORE_STAT restore_stat;
 };
 
 typedef struct handle_manager HANDLE_MANAGER;
 struct handle_manager
 {
-    BACKUP_HANDLE backup_handle;
-    RESTORE_HANDLE restore_handle;
+    pthread_mutex_t handle_mgr_mutex;
+
+    int max_backup_handle_count;
+    int max_restore_handle_count;
+
+    BACKUP_HANDLE* backup_handles;
+    RESTORE_HANDLE* restore_handles;
 };
 
 extern HANDLE_MANAGER* handle_mgr;
@@ -82,7 +247,10 @@ int start_handle_manager (void);
 int stop_handle_manager (void);
 int alloc_handle (HANDLE_TYPE, void**);
 int free_handle (HANDLE_TYPE, void*);
-int validate_handle (HANDLE_TYPE, void*);
-int set_thread_state (HANDLE_TYPE, void*, THREAD_STATE);
+int register_handle (HANDLE_TYPE, void*);
+void* get_handle_id (HANDLE_TYPE, void*);
+int validate_handle (HANDLE_TYPE, void*, void**);
+int check_handle_state (HANDLE_TYPE, void*, HANDLE_STATE);
+int transit_handle_state (HANDLE_TYPE, void*, HANDLE_STATE, HANDLE_STATE);
 
 #endif
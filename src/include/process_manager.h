@@ -0,0 +1,44 @@
+#ifndef _PROCESS_MANAGER_H_
+#define _PROCESS_MANAGER_H_
+
+#include <pthread.h>
+#include "handle_manager.h"
+
+/* used when pidfd is not available */
+#define PROCESS_POLL_INTERVAL_MSECS (100)
+
+/* SIGTERM -> SIGKILL */
+#define PROCESS_KILL_GRACE_MSECS (5000)
+
+#define MAX_EPOLL_EVENTS (16)
+
+typedef struct process_manager PROCESS_MANAGER;
+struct process_manager
+{
+    pthread_t supervisor_thread;
+
+    pthread_mutex_t process_mgr_mutex;
+    pthread_cond_t process_mgr_cond; /* broadcast when a backup process is reaped */
+
+    int epoll_fd;
+    int event_fd; /* wakes up the supervisor thread */
+
+    bool use_pidfd;
+    bool is_shutdown;
+
+    int max_child_count;
+    int child_count;
+    BACKUP_HANDLE** children;
+};
+
+extern PROCESS_MANAGER* process_mgr;
+
+int start_process_manager (void);
+int stop_process_manager (void);
+int supervise_backup_process (BACKUP_HANDLE*);
+void cancel_backup_process (BACKUP_HANDLE*);
+void wait_backup_process (BACKUP_HANDLE*);
+void wait_backup_process_timeout (BACKUP_HANDLE*, int);
+PROCESS_STATE get_process_state (BACKUP_HANDLE*);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef _READ_AHEAD_H_
+#define _READ_AHEAD_H_
+
+#include <pthread.h>
+#include "handle_manager.h"
+
+/* fifo -> spill file at a time */
+#define SPILL_IO_SIZE (1024 * 1024)
+
+typedef enum read_ahead_state READ_AHEAD_STATE;
+enum read_ahead_state
+{
+    READ_AHEAD_STATE_RUNNING,
+    READ_AHEAD_STATE_EOF,   /* the backup process exited and the fifo has been drained */
+    READ_AHEAD_STATE_ERROR
+};
+
+/*
+ * single-producer/single-consumer ring between the backup fifo and cubrid_backup_read ()
+ *
+ * head, tail 은 계속 증가만 하며 ring 안의 위치는 (% ring_size) 로 구한다.
+ * - head: prefetch thread 만 쓴다.
+ * - tail: cubrid_backup_read () (backup_mutex 를 잡은 thread) 만 쓴다.
+ */
+struct read_ahead
+{
+    pthread_t prefetch_thread;
+
+    char* ring;
+    unsigned long long ring_size;
+
+    unsigned long long head; /* accessed atomically */
+    unsigned long long tail; /* accessed atomically */
+
+    int data_event_fd;  /* prefetch thread -> reader, ring is no longer empty */
+    int space_event_fd; /* reader -> prefetch thread, ring is no longer full (or stop) */
+
+    bool is_stop;           /* accessed atomically */
+    READ_AHEAD_STATE state; /* accessed atomically */
+
+    /*
+     * spill: ring 이 가득 차면 fifo 를 scratch file 에 이어서 쓴다. (prefetch thread 만 사용한다.)
+     * spill file 도 spill_size 크기의 ring 처럼 사용하며, ring 보다 나중의 data 를 담는다.
+     */
+    int spill_fd; /* -1: no spill */
+    unsigned long long spill_size;
+    unsigned long long spill_head;
+    unsigned long long spill_tail;
+    char* spill_buffer; /* SPILL_IO_SIZE */
+};
+
+int start_read_ahead (BACKUP_HANDLE*);
+void stop_read_ahead (BACKUP_HANDLE*);
+unsigned int peek_read_ahead (READ_AHEAD*, char**);
+void release_read_ahead (READ_AHEAD*, unsigned int);
+void rearm_read_ahead (READ_AHEAD*);
+int wait_read_ahead (READ_AHEAD*, int, bool*);
+READ_AHEAD_STATE get_read_ahead_state (READ_AHEAD*);
+
+#endif
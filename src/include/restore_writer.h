@@ -0,0 +1,75 @@
+#ifndef _RESTORE_WRITER_H_
+#define _RESTORE_WRITER_H_
+
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include "async_io.h"
+#include "handle_manager.h"
+
+/* a copy of the data of one cubrid_restore_write () until its write completes */
+typedef struct write_slot WRITE_SLOT;
+struct write_slot
+{
+    char* buffer;
+    unsigned int capacity;
+    unsigned int data_len;
+    unsigned int written;
+    long long offset;
+    struct iovec iov; /* IORING_OP_WRITEV */
+};
+
+/*
+ * restore_fd 에 최대 queue_depth 개의 write 를 동시에 걸어 둔다.
+ * io_uring 을 사용할 수 없으면 async_io worker thread 가 대신 pwrite () 한다.
+ * restore_mutex 를 잡은 thread 만 사용한다.
+ */
+struct restore_writer
+{
+    int restore_fd;
+    unsigned int queue_depth;
+
+    WRITE_SLOT slots[MAX_WRITE_QUEUE_DEPTH];
+    unsigned int free_slots[MAX_WRITE_QUEUE_DEPTH]; /* stack of idle slot indexes */
+    unsigned int free_count;
+
+    long long write_offset; /* file offset of the next write */
+    int write_errno;        /* first failed write, 0: none */
+
+    /*
+     * direct_io_size: data 를 extent_size 만큼 slot 에 모은 뒤에 쓴다.
+     * slot 은 DIRECT_IO_ALIGN 에 맞춰 할당되며, 마지막의 남은 data 는 stop_restore_writer () 가 쓴다.
+     */
+    unsigned int extent_size; /* 0: one slot per cubrid_restore_write () */
+    int staging_slot;         /* slot being filled, -1: none */
+    bool is_direct_io;        /* restore_fd is opened with O_DIRECT */
+
+    bool use_io_uring;
+    int event_fd; /* signaled when a write completes */
+
+    /* io_uring */
+    int ring_fd;
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe* sqes;
+    size_t sqes_size;
+    unsigned int* sq_flags;
+    unsigned int* sq_tail;
+    unsigned int* sq_mask;
+    unsigned int* sq_array;
+    unsigned int* cq_head;
+    unsigned int* cq_tail;
+    unsigned int* cq_mask;
+    struct io_uring_cqe* cqes;
+
+    /* fallback */
+    ASYNC_IO* async_io;
+};
+
+int start_restore_writer (RESTORE_HANDLE*);
+int stop_restore_writer (RESTORE_HANDLE*);
+int queue_restore_write (RESTORE_WRITER*, void*, unsigned int, bool, unsigned int*);
+int sync_restore_writer (RESTORE_WRITER*, long long*);
+
+#endif
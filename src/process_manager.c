@@ -0,0 +1,668 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include "process_manager.h"
+
+/*
+ * process manager
+ *
+ * 하나의 supervisor thread 가 모든 backup process (cubrid backupdb) 를 감시한다.
+ * - 종료 감지: pidfd 를 epoll 에 등록한다.
+ *              pidfd 를 사용할 수 없는 kernel 에서는 PROCESS_POLL_INTERVAL_MSECS 마다 waitpid () 한다.
+ * - cancel   : handle 마다 cancel_fd (eventfd) 를 epoll 에 등록하고, signal 되면 바로 SIGTERM 을 보낸다.
+ *
+ * SIGCHLD handler 는 설치하지 않으므로 library 를 사용하는 process 의 SIGCHLD 처리에 영향을 주지 않는다.
+ */
+
+PROCESS_MANAGER process_manager;
+
+PROCESS_MANAGER* process_mgr = &process_manager;
+
+static
+int open_pidfd (pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    return (int)syscall (SYS_pidfd_open, pid, 0);
+#else
+    errno = ENOSYS;
+
+    return -1;
+#endif
+}
+
+static
+long long elapsed_msecs (struct timespec* since)
+{
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - since->tv_sec) * 1000LL + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+static
+void kill_process_group (pid_t pgid, int signo)
+{
+    // backup process (cubrid) 는 자신이 leader 인 process group 을 가지므로
+    // (spawn_process () 참고) 다른 backup 이나 backup-api library 자체는
+    // signal 을 받지 않는다.
+    killpg (pgid, signo);
+
+#if 0
+    // FAILURE: Has been interrupted. 를 cubrid_utility.log 에 남기기 위해
+    // SIGINT 를 사용하려고 했으나, cub_admin 에서 SIG_INT 핸들러를 등록해두어서
+    // cub_admin 이 바로 죽지 않는다.
+    // FAILURE: Has been interrupted. 로그를 남긴다는 것 자체가 정상 종료(예외처리) 했다는 것이다.
+    sigaction (SIGINT, &act, &old_act);
+
+    killpg (pgid, SIGINT);
+
+    sigaction (SIGINT, &old_act, NULL);
+#endif
+}
+
+static
+int check_exit_status (int status)
+{
+    /* backup process(cubrid) return or exit () */
+    if (WIFEXITED (status))
+    {
+        /*
+         * backup process return value:
+         * 0 - backup success
+         * 1 - backup failure
+         */
+        if (WEXITSTATUS(status))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+    /* backup process is dead by signal */
+    else if (WIFSIGNALED(status)) /* signal */
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * process_mgr_mutex 를 잡은 상태에서 호출한다.
+ */
+static
+void reap_backup_process (int child_idx)
+{
+    BACKUP_HANDLE* backup_handle;
+    PROCESS_STATE process_state;
+
+    pid_t retval;
+    int status;
+
+    backup_handle = process_mgr->children[child_idx];
+
+    retval = waitpid (backup_handle->backup_pid, &status, WNOHANG);
+
+    if (retval == 0)
+    {
+        /* still running */
+        return;
+    }
+    else if (retval == -1)
+    {
+        // ECHILD: library 를 사용하는 process 가 SIGCHLD 를 SIG_IGN 으로 설정했거나
+        // 직접 wait () 하여 exit status 를 알 수 없다.
+        PRINT_LOG_ERR (ERR_INFO);
+
+        process_state = PROCESS_STATE_EXIT_WITH_ERROR;
+    }
+    else if (IS_FAILURE (check_exit_status (status)))
+    {
+        PRINT_LOG_INFO ("backup process exit, db_name => %s, pid => %d, status => %d\n",
+                        backup_handle->db_name,
+                        backup_handle->backup_pid,
+                        status);
+
+        process_state = PROCESS_STATE_EXIT_WITH_ERROR;
+    }
+    else
+    {
+        process_state = PROCESS_STATE_EXIT;
+    }
+
+    if (backup_handle->pid_fd != -1)
+    {
+        /* close () also removes it from epoll_fd */
+        close (backup_handle->pid_fd);
+        backup_handle->pid_fd = -1;
+    }
+
+    /* cancel_fd lives as long as the handle slot */
+    epoll_ctl (process_mgr->epoll_fd, EPOLL_CTL_DEL, backup_handle->cancel_fd, NULL);
+
+    backup_handle->backup_stat.process_msecs = elapsed_msecs (&backup_handle->backup_stat.launch_time);
+
+    __atomic_store_n (&backup_handle->backup_process_state, process_state, __ATOMIC_RELEASE);
+
+    /* cubrid_backup_get_pollfd () 로 기다리는 application 을 깨운다. (state 를 바꾼 뒤에) */
+    signal_event_fd (backup_handle->exit_fd);
+
+    process_mgr->child_count --;
+    process_mgr->children[child_idx] = process_mgr->children[process_mgr->child_count];
+    process_mgr->children[process_mgr->child_count] = NULL;
+
+    pthread_cond_broadcast (&process_mgr->process_mgr_cond);
+}
+
+/*
+ * process_mgr_mutex 를 잡은 상태에서 호출한다.
+ * cancel 된 backup process 에 signal 을 보내고, 다음 epoll_wait () timeout 을 계산한다.
+ */
+static
+int check_backup_processes (void)
+{
+    BACKUP_HANDLE* backup_handle;
+
+    long long remain_msecs;
+    int timeout_msecs = -1;
+    int i;
+
+    for (i = process_mgr->child_count - 1; i >= 0; i --)
+    {
+        if (process_mgr->use_pidfd == false)
+        {
+            reap_backup_process (i);
+
+            if (i >= process_mgr->child_count)
+            {
+                continue;
+            }
+        }
+
+        backup_handle = process_mgr->children[i];
+
+        if (backup_handle->is_cancel == false)
+        {
+            continue;
+        }
+
+        if (backup_handle->kill_signal == 0)
+        {
+            kill_process_group (backup_handle->backup_pid, SIGTERM);
+
+            backup_handle->kill_signal = SIGTERM;
+            clock_gettime (CLOCK_MONOTONIC, &backup_handle->kill_time);
+        }
+
+        if (backup_handle->kill_signal == SIGTERM)
+        {
+            remain_msecs = PROCESS_KILL_GRACE_MSECS - elapsed_msecs (&backup_handle->kill_time);
+
+            if (remain_msecs <= 0)
+            {
+                PRINT_LOG_INFO ("backup process does not exit on SIGTERM, db_name => %s, pid => %d\n",
+                                backup_handle->db_name,
+                                backup_handle->backup_pid);
+
+                kill_process_group (backup_handle->backup_pid, SIGKILL);
+
+                backup_handle->kill_signal = SIGKILL;
+            }
+            else if (timeout_msecs == -1 || remain_msecs < timeout_msecs)
+            {
+                timeout_msecs = (int)remain_msecs;
+            }
+        }
+    }
+
+    if (process_mgr->use_pidfd == false && process_mgr->child_count > 0)
+    {
+        if (timeout_msecs == -1 || timeout_msecs > PROCESS_POLL_INTERVAL_MSECS)
+        {
+            timeout_msecs = PROCESS_POLL_INTERVAL_MSECS;
+        }
+    }
+
+    return timeout_msecs;
+}
+
+static
+void* supervise_backup_processes (void* arg)
+{
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    BACKUP_HANDLE* backup_handle;
+
+    int timeout_msecs = -1;
+    int event_count;
+    int i, j;
+
+    while (true)
+    {
+        event_count = epoll_wait (process_mgr->epoll_fd, events, MAX_EPOLL_EVENTS, timeout_msecs);
+
+        if (event_count == -1)
+        {
+            if (errno != EINTR)
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+            }
+
+            event_count = 0;
+        }
+
+        pthread_mutex_lock (&process_mgr->process_mgr_mutex);
+
+        for (i = 0; i < event_count; i ++)
+        {
+            if (events[i].data.fd == process_mgr->event_fd)
+            {
+                drain_event_fd (process_mgr->event_fd);
+
+                continue;
+            }
+
+            for (j = 0; j < process_mgr->child_count; j ++)
+            {
+                backup_handle = process_mgr->children[j];
+
+                /* pidfd is readable: the backup process has exited */
+                if (backup_handle->pid_fd == events[i].data.fd)
+                {
+                    reap_backup_process (j);
+
+                    break;
+                }
+
+                /* cancel_backup_process () */
+                if (backup_handle->cancel_fd == events[i].data.fd)
+                {
+                    drain_event_fd (backup_handle->cancel_fd);
+
+                    backup_handle->is_cancel = true;
+
+                    break;
+                }
+            }
+        }
+
+        if (process_mgr->is_shutdown == true)
+        {
+            pthread_mutex_unlock (&process_mgr->process_mgr_mutex);
+
+            break;
+        }
+
+        timeout_msecs = check_backup_processes ();
+
+        pthread_mutex_unlock (&process_mgr->process_mgr_mutex);
+    }
+
+    return NULL;
+}
+
+static
+int initialize_process_manager (void)
+{
+    struct epoll_event event;
+    pthread_condattr_t cond_attr;
+    int pid_fd;
+    int retval;
+
+    int state = 0;
+
+    process_mgr->epoll_fd    = -1;
+    process_mgr->event_fd    = -1;
+    process_mgr->is_shutdown = false;
+    process_mgr->child_count = 0;
+
+    process_mgr->max_child_count = backup_mgr->default_backup_option.max_handle_count;
+
+    process_mgr->children = (BACKUP_HANDLE **)calloc (process_mgr->max_child_count, sizeof (BACKUP_HANDLE *));
+
+    if (IS_NULL (process_mgr->children))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    if (IS_FAILURE (pthread_mutex_init (&process_mgr->process_mgr_mutex, NULL)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 2;
+
+    // wait_backup_process_timeout () 이 시스템 시간 변경의 영향을 받지 않도록 한다.
+    pthread_condattr_init (&cond_attr);
+    pthread_condattr_setclock (&cond_attr, CLOCK_MONOTONIC);
+
+    retval = pthread_cond_init (&process_mgr->process_mgr_cond, &cond_attr);
+
+    pthread_condattr_destroy (&cond_attr);
+
+    if (IS_FAILURE (retval))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 3;
+
+    /* close-on-exec: backup process 에 상속되지 않도록 한다. */
+    process_mgr->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+
+    if (process_mgr->epoll_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 4;
+
+    process_mgr->event_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (process_mgr->event_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 5;
+
+    event.events  = EPOLLIN;
+    event.data.fd = process_mgr->event_fd;
+
+    if (-1 == epoll_ctl (process_mgr->epoll_fd, EPOLL_CTL_ADD, process_mgr->event_fd, &event))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    /* pidfd_open () 은 linux 5.3 부터 지원한다. */
+    pid_fd = open_pidfd (getpid ());
+
+    if (pid_fd != -1)
+    {
+        close (pid_fd);
+
+        process_mgr->use_pidfd = true;
+    }
+    else
+    {
+        PRINT_LOG_INFO ("pidfd is not available, errno => %d, poll interval => %d msecs\n",
+                        errno,
+                        PROCESS_POLL_INTERVAL_MSECS);
+
+        process_mgr->use_pidfd = false;
+    }
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 5:
+            close (process_mgr->event_fd);
+            process_mgr->event_fd = -1;
+        case 4:
+            close (process_mgr->epoll_fd);
+            process_mgr->epoll_fd = -1;
+        case 3:
+            pthread_cond_destroy (&process_mgr->process_mgr_cond);
+        case 2:
+            pthread_mutex_destroy (&process_mgr->process_mgr_mutex);
+        case 1:
+            free (process_mgr->children);
+            process_mgr->children = NULL;
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+static
+int finalize_process_manager (void)
+{
+    close (process_mgr->event_fd);
+    close (process_mgr->epoll_fd);
+
+    process_mgr->event_fd = -1;
+    process_mgr->epoll_fd = -1;
+
+    pthread_cond_destroy (&process_mgr->process_mgr_cond);
+    pthread_mutex_destroy (&process_mgr->process_mgr_mutex);
+
+    free (process_mgr->children);
+    process_mgr->children = NULL;
+
+    process_mgr->max_child_count = 0;
+    process_mgr->child_count = 0;
+
+    return SUCCESS;
+}
+
+int start_process_manager (void)
+{
+    if (IS_FAILURE (initialize_process_manager ()))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (pthread_create (&process_mgr->supervisor_thread, NULL, supervise_backup_processes, NULL)))
+    {
+        finalize_process_manager ();
+
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * stop_handle_manager () 이후에 호출한다.
+ * (handle 이 free 될 때 backup process 가 모두 회수된다.)
+ */
+int stop_process_manager (void)
+{
+    pthread_mutex_lock (&process_mgr->process_mgr_mutex);
+
+    if (process_mgr->child_count > 0)
+    {
+        PRINT_LOG_INFO ("stop_process_manager (), child_count => %d\n", process_mgr->child_count);
+    }
+
+    process_mgr->is_shutdown = true;
+
+    pthread_mutex_unlock (&process_mgr->process_mgr_mutex);
+
+    signal_event_fd (process_mgr->event_fd);
+
+    if (IS_FAILURE (pthread_join (process_mgr->supervisor_thread, NULL)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    if (IS_FAILURE (finalize_process_manager ()))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/*
+ * backup_handle->backup_pid 의 종료를 supervisor thread 가 감시하도록 등록한다.
+ * 실패하면 backup process 는 아직 회수되지 않은 상태이다.
+ */
+int supervise_backup_process (BACKUP_HANDLE* backup_handle)
+{
+    struct epoll_event event;
+
+    int state = 0;
+
+    if (IS_FAILURE (pthread_mutex_lock (&process_mgr->process_mgr_mutex)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    if (process_mgr->child_count >= process_mgr->max_child_count)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    /* 이전 session 에서 남은 cancel 요청과 종료 통지는 버린다. */
+    drain_event_fd (backup_handle->cancel_fd);
+    drain_event_fd (backup_handle->exit_fd);
+
+    event.events  = EPOLLIN;
+    event.data.fd = backup_handle->cancel_fd;
+
+    if (-1 == epoll_ctl (process_mgr->epoll_fd, EPOLL_CTL_ADD, backup_handle->cancel_fd, &event))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 2;
+
+    if (process_mgr->use_pidfd == true)
+    {
+        backup_handle->pid_fd = open_pidfd (backup_handle->backup_pid);
+
+        if (backup_handle->pid_fd == -1)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        state = 3;
+
+        event.events  = EPOLLIN;
+        event.data.fd = backup_handle->pid_fd;
+
+        if (-1 == epoll_ctl (process_mgr->epoll_fd, EPOLL_CTL_ADD, backup_handle->pid_fd, &event))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+    }
+
+    backup_handle->is_cancel   = false;
+    backup_handle->kill_signal = 0;
+
+    __atomic_store_n (&backup_handle->backup_process_state, PROCESS_STATE_RUNNING, __ATOMIC_RELEASE);
+
+    process_mgr->children[process_mgr->child_count ++] = backup_handle;
+
+    pthread_mutex_unlock (&process_mgr->process_mgr_mutex);
+
+    /* polling 모드에서는 supervisor 가 timeout 없이 대기 중일 수 있다. */
+    if (process_mgr->use_pidfd == false)
+    {
+        signal_event_fd (process_mgr->event_fd);
+    }
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 3:
+            close (backup_handle->pid_fd);
+            backup_handle->pid_fd = -1;
+        case 2:
+            epoll_ctl (process_mgr->epoll_fd, EPOLL_CTL_DEL, backup_handle->cancel_fd, NULL);
+        case 1:
+            pthread_mutex_unlock (&process_mgr->process_mgr_mutex);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/*
+ * backup process 의 종료를 요청하고 바로 return 한다. (lock 을 잡지 않는다.)
+ * SIGTERM 후 PROCESS_KILL_GRACE_MSECS 안에 종료되지 않으면 SIGKILL 을 보낸다.
+ */
+void cancel_backup_process (BACKUP_HANDLE* backup_handle)
+{
+    signal_event_fd (backup_handle->cancel_fd);
+}
+
+void wait_backup_process (BACKUP_HANDLE* backup_handle)
+{
+    pthread_mutex_lock (&process_mgr->process_mgr_mutex);
+
+    while (get_process_state (backup_handle) == PROCESS_STATE_RUNNING)
+    {
+        pthread_cond_wait (&process_mgr->process_mgr_cond, &process_mgr->process_mgr_mutex);
+    }
+
+    pthread_mutex_unlock (&process_mgr->process_mgr_mutex);
+}
+
+void wait_backup_process_timeout (BACKUP_HANDLE* backup_handle, int timeout_msecs)
+{
+    struct timespec deadline;
+
+    clock_gettime (CLOCK_MONOTONIC, &deadline);
+
+    deadline.tv_sec  += timeout_msecs / 1000;
+    deadline.tv_nsec += (timeout_msecs % 1000) * 1000000L;
+
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec  += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock (&process_mgr->process_mgr_mutex);
+
+    while (get_process_state (backup_handle) == PROCESS_STATE_RUNNING)
+    {
+        if (pthread_cond_timedwait (&process_mgr->process_mgr_cond, &process_mgr->process_mgr_mutex, &deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock (&process_mgr->process_mgr_mutex);
+}
+
+PROCESS_STATE get_process_state (BACKUP_HANDLE* backup_handle)
+{
+    return __atomic_load_n (&backup_handle->backup_process_state, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,630 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+#include "read_ahead.h"
+#include "process_manager.h"
+
+/*
+ * read-ahead
+ *
+ * read_ahead_size 가 설정되면 backup handle 마다 prefetch thread 를 하나 두고
+ * backup fifo 를 ring 으로 미리 읽어 둔다.
+ * cubrid_backup_read () 를 늦게 호출하더라도 ring 이 찰 때까지는 cubrid backupdb 가 멈추지 않는다.
+ * ring 이 가득 차면 prefetch thread 는 fifo 를 읽지 않고 기다리며, fifo 가 차면 cubrid backupdb 도 기다린다.
+ *
+ * spill_size 가 설정되면 ring 이 가득 찬 동안 fifo 를 backup_home 의 scratch file 로 옮기고,
+ * ring 이 비는 대로 scratch file 에서 다시 채운다.
+ * cubrid backupdb 는 reader 속도와 관계없이 (spill_size 까지는) local disk 속도로 끝난다.
+ *
+ * head/tail 은 __ATOMIC_SEQ_CST 로 읽고 쓴다.
+ * 상대편이 잠들기 직전에 확인한 값을 기준으로 빈 ring -> data, 가득 찬 ring -> 빈 공간이 될 때만
+ * eventfd 로 깨우므로 한 쪽이 계속 잠들어 있는 경우는 없다.
+ */
+
+static
+void set_read_ahead_state (READ_AHEAD* read_ahead, READ_AHEAD_STATE state)
+{
+    __atomic_store_n (&read_ahead->state, state, __ATOMIC_SEQ_CST);
+
+    signal_event_fd (read_ahead->data_event_fd);
+}
+
+static
+void publish_ring_data (READ_AHEAD* read_ahead, unsigned long long head, unsigned int len)
+{
+    __atomic_store_n (&read_ahead->head, head + len, __ATOMIC_SEQ_CST);
+
+    // reader 가 비어 있는 ring 을 보고 잠들었을 수 있다.
+    if (__atomic_load_n (&read_ahead->tail, __ATOMIC_SEQ_CST) == head)
+    {
+        signal_event_fd (read_ahead->data_event_fd);
+    }
+}
+
+/* copies len bytes from the fifo data in spill_buffer to the spill file */
+static
+int write_spill (READ_AHEAD* read_ahead, unsigned long long len)
+{
+    unsigned long long written = 0;
+    unsigned long long offset;
+    unsigned long long chunk;
+    ssize_t write_size;
+
+    while (written < len)
+    {
+        offset = (read_ahead->spill_head + written) % read_ahead->spill_size;
+        chunk  = len - written;
+
+        if (offset + chunk > read_ahead->spill_size)
+        {
+            chunk = read_ahead->spill_size - offset;
+        }
+
+        write_size = pwrite (read_ahead->spill_fd, read_ahead->spill_buffer + written, chunk, offset);
+
+        if (write_size == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        written += write_size;
+    }
+
+    read_ahead->spill_head += len;
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+/* moves the oldest spilled data into the free space of the ring */
+static
+int refill_ring (READ_AHEAD* read_ahead, unsigned long long head, unsigned long long free_len)
+{
+    unsigned long long ring_offset;
+    unsigned long long spill_offset;
+    unsigned long long len;
+    ssize_t read_size;
+
+    ring_offset  = head % read_ahead->ring_size;
+    spill_offset = read_ahead->spill_tail % read_ahead->spill_size;
+
+    len = read_ahead->spill_head - read_ahead->spill_tail;
+
+    if (len > free_len)
+    {
+        len = free_len;
+    }
+
+    if (ring_offset + len > read_ahead->ring_size)
+    {
+        len = read_ahead->ring_size - ring_offset;
+    }
+
+    if (spill_offset + len > read_ahead->spill_size)
+    {
+        len = read_ahead->spill_size - spill_offset;
+    }
+
+    do
+    {
+        read_size = pread (read_ahead->spill_fd, read_ahead->ring + ring_offset, len, spill_offset);
+    } while (read_size == -1 && errno == EINTR);
+
+    if (read_size <= 0)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    read_ahead->spill_tail += read_size;
+
+    publish_ring_data (read_ahead, head, read_size);
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+static
+void wait_ring_space (READ_AHEAD* read_ahead)
+{
+    struct pollfd poll_fd;
+
+    poll_fd.fd      = read_ahead->space_event_fd;
+    poll_fd.events  = POLLIN;
+    poll_fd.revents = 0;
+
+    poll (&poll_fd, 1, -1);
+
+    drain_event_fd (read_ahead->space_event_fd);
+}
+
+static
+void* prefetch_backup_data (void* arg)
+{
+    BACKUP_HANDLE* backup_handle = (BACKUP_HANDLE *)arg;
+    READ_AHEAD* read_ahead = backup_handle->read_ahead;
+
+    struct pollfd poll_fds[2];
+    struct iovec iov[2];
+    int iov_count;
+
+    unsigned long long head;
+    unsigned long long tail;
+    unsigned long long free_len;
+    unsigned long long spill_len;
+    unsigned long long offset;
+    ssize_t read_size;
+
+    bool is_full = false;
+    bool is_hangup = false;
+    bool is_fifo_end = false;
+
+    while (__atomic_load_n (&read_ahead->is_stop, __ATOMIC_SEQ_CST) == false)
+    {
+        head = read_ahead->head;
+        tail = __atomic_load_n (&read_ahead->tail, __ATOMIC_SEQ_CST);
+
+        free_len  = read_ahead->ring_size - (head - tail);
+        spill_len = read_ahead->spill_head - read_ahead->spill_tail;
+
+        // spill file 에는 ring 보다 나중의 data 가 있으므로 ring 이 비는 대로 먼저 옮긴다.
+        if (spill_len > 0 && free_len > 0)
+        {
+            if (IS_FAILURE (refill_ring (read_ahead, head, free_len)))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+
+                set_read_ahead_state (read_ahead, READ_AHEAD_STATE_ERROR);
+                goto end;
+            }
+
+            continue;
+        }
+
+        if (is_fifo_end == true)
+        {
+            if (IS_ZERO (spill_len))
+            {
+                set_read_ahead_state (read_ahead, READ_AHEAD_STATE_EOF);
+                goto end;
+            }
+
+            wait_ring_space (read_ahead);
+
+            continue;
+        }
+
+        if (free_len > 0 && IS_ZERO (spill_len))
+        {
+            is_full = false;
+
+            // ring 의 끝에서 잘리는 경우 두 조각을 한 번의 readv () 로 채운다.
+            offset = head % read_ahead->ring_size;
+
+            iov[0].iov_base = read_ahead->ring + offset;
+
+            if (offset + free_len <= read_ahead->ring_size)
+            {
+                iov[0].iov_len = free_len;
+                iov_count = 1;
+            }
+            else
+            {
+                iov[0].iov_len  = read_ahead->ring_size - offset;
+                iov[1].iov_base = read_ahead->ring;
+                iov[1].iov_len  = free_len - iov[0].iov_len;
+                iov_count = 2;
+            }
+
+            read_size = readv (backup_handle->fifo_fd, iov, iov_count);
+
+            if (read_size > 0)
+            {
+                publish_ring_data (read_ahead, head, read_size);
+            }
+        }
+        else if (read_ahead->spill_fd != -1 && spill_len < read_ahead->spill_size)
+        {
+            is_full = false;
+
+            // reader 가 느리더라도 cubrid backupdb 는 local disk 속도로 끝낼 수 있도록 한다.
+            free_len = read_ahead->spill_size - spill_len;
+
+            read_size = read (backup_handle->fifo_fd, read_ahead->spill_buffer, (free_len < SPILL_IO_SIZE) ? free_len : SPILL_IO_SIZE);
+
+            if (read_size > 0)
+            {
+                if (IS_FAILURE (write_spill (read_ahead, read_size)))
+                {
+                    PRINT_LOG_ERR (ERR_INFO);
+
+                    set_read_ahead_state (read_ahead, READ_AHEAD_STATE_ERROR);
+                    goto end;
+                }
+
+                if (spill_len + read_size > backup_handle->backup_stat.spill_high_water)
+                {
+                    backup_handle->backup_stat.spill_high_water = spill_len + read_size;
+                }
+
+                backup_handle->backup_stat.spill_bytes += read_size;
+            }
+        }
+        else
+        {
+            // backpressure: ring (과 spill file) 이 빌 때까지 fifo 를 읽지 않는다.
+            if (is_full == false)
+            {
+                backup_handle->backup_stat.ring_full_count ++;
+                is_full = true;
+            }
+
+            wait_ring_space (read_ahead);
+
+            continue;
+        }
+
+        backup_handle->backup_stat.read_syscall_count ++;
+
+        if (read_size > 0)
+        {
+            continue;
+        }
+        else if (read_size == 0)
+        {
+            /* no writer on the fifo */
+            switch (get_process_state (backup_handle))
+            {
+                case PROCESS_STATE_EXIT:
+                    // spill file 에 남은 data 는 reader 가 따라오는 대로 ring 으로 옮긴다.
+                    is_fifo_end = true;
+                    continue;
+                case PROCESS_STATE_EXIT_WITH_ERROR:
+                    set_read_ahead_state (read_ahead, READ_AHEAD_STATE_ERROR);
+                    goto end;
+                default:
+                    break;
+            }
+
+            // writer 가 fifo 를 닫은 뒤에는 poll () 이 바로 return 하므로
+            // backup process 가 회수되거나 다시 fifo 를 열 때까지 잠시 기다린다.
+            if (is_hangup == true)
+            {
+                wait_backup_process_timeout (backup_handle, PROCESS_POLL_INTERVAL_MSECS);
+
+                is_hangup = false;
+
+                continue;
+            }
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno != EAGAIN)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            set_read_ahead_state (read_ahead, READ_AHEAD_STATE_ERROR);
+            goto end;
+        }
+
+        poll_fds[0].fd      = backup_handle->fifo_fd;
+        poll_fds[0].events  = POLLIN;
+        poll_fds[0].revents = 0;
+
+        poll_fds[1].fd      = read_ahead->space_event_fd;
+        poll_fds[1].events  = POLLIN;
+        poll_fds[1].revents = 0;
+
+        // backup process 가 fifo 를 열기 전에 종료되는 경우를 위해 주기적으로 깨어난다.
+        if (poll (poll_fds, 2, PROCESS_POLL_INTERVAL_MSECS) > 0)
+        {
+            is_hangup = ((poll_fds[0].revents & POLLHUP) && !(poll_fds[0].revents & POLLIN)) ? true : false;
+
+            if (poll_fds[1].revents & POLLIN)
+            {
+                drain_event_fd (read_ahead->space_event_fd);
+            }
+        }
+
+        backup_handle->backup_stat.read_syscall_count ++;
+    }
+
+end:
+
+    return NULL;
+}
+
+/*
+ * spill file 은 fifo 옆 (backup_home) 에 만들고 바로 unlink 하므로
+ * library 를 사용하는 process 가 비정상 종료되더라도 남지 않는다.
+ */
+static
+int open_spill_file (BACKUP_HANDLE* backup_handle, READ_AHEAD* read_ahead)
+{
+    char spill_path[PATH_MAX];
+
+    if (snprintf (spill_path, PATH_MAX, "%s.spill", backup_handle->fifo_path) >= PATH_MAX)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    read_ahead->spill_fd = open (spill_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+
+    if (read_ahead->spill_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    unlink (spill_path);
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+int start_read_ahead (BACKUP_HANDLE* backup_handle)
+{
+    BACKUP_OPTION* backup_opt = &backup_mgr->default_backup_option;
+    READ_AHEAD* read_ahead;
+    unsigned int ring_size;
+
+    int state = 0;
+
+    ring_size = (backup_opt->read_ahead_size > 0) ? backup_opt->read_ahead_size : DEFAULT_SPILL_RING_SIZE;
+
+    read_ahead = (READ_AHEAD *)malloc (sizeof (READ_AHEAD));
+
+    if (IS_NULL (read_ahead))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    read_ahead->ring = (char *)malloc (ring_size);
+
+    if (IS_NULL (read_ahead->ring))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 2;
+
+    read_ahead->ring_size = ring_size;
+    read_ahead->head      = 0;
+    read_ahead->tail      = 0;
+    read_ahead->is_stop   = false;
+    read_ahead->state     = READ_AHEAD_STATE_RUNNING;
+
+    read_ahead->spill_fd     = -1;
+    read_ahead->spill_size   = backup_opt->spill_size;
+    read_ahead->spill_head   = 0;
+    read_ahead->spill_tail   = 0;
+    read_ahead->spill_buffer = NULL;
+
+    read_ahead->data_event_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (read_ahead->data_event_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 3;
+
+    read_ahead->space_event_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (read_ahead->space_event_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 4;
+
+    if (read_ahead->spill_size > 0)
+    {
+        read_ahead->spill_buffer = (char *)malloc (SPILL_IO_SIZE);
+
+        if (IS_NULL (read_ahead->spill_buffer))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        state = 5;
+
+        if (IS_FAILURE (open_spill_file (backup_handle, read_ahead)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        state = 6;
+    }
+
+    backup_handle->read_ahead = read_ahead;
+
+    if (IS_FAILURE (pthread_create (&read_ahead->prefetch_thread, NULL, prefetch_backup_data, backup_handle)))
+    {
+        backup_handle->read_ahead = NULL;
+
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 6:
+            close (read_ahead->spill_fd);
+        case 5:
+            free (read_ahead->spill_buffer);
+        case 4:
+            close (read_ahead->space_event_fd);
+        case 3:
+            close (read_ahead->data_event_fd);
+        case 2:
+            free (read_ahead->ring);
+        case 1:
+            free (read_ahead);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/*
+ * prefetch thread 를 멈추고 ring 을 해제한다.
+ * fifo 를 닫기 전에 호출해야 한다.
+ */
+void stop_read_ahead (BACKUP_HANDLE* backup_handle)
+{
+    READ_AHEAD* read_ahead = backup_handle->read_ahead;
+
+    if (IS_NULL (read_ahead))
+    {
+        return;
+    }
+
+    __atomic_store_n (&read_ahead->is_stop, true, __ATOMIC_SEQ_CST);
+
+    signal_event_fd (read_ahead->space_event_fd);
+
+    pthread_join (read_ahead->prefetch_thread, NULL);
+
+    if (read_ahead->spill_fd != -1)
+    {
+        close (read_ahead->spill_fd);
+        free (read_ahead->spill_buffer);
+    }
+
+    close (read_ahead->space_event_fd);
+    close (read_ahead->data_event_fd);
+
+    free (read_ahead->ring);
+    free (read_ahead);
+
+    backup_handle->read_ahead = NULL;
+}
+
+/* returns the length of the data readable at *data without wrapping around */
+unsigned int peek_read_ahead (READ_AHEAD* read_ahead, char** data)
+{
+    unsigned long long head;
+    unsigned long long tail;
+    unsigned long long offset;
+    unsigned long long len;
+
+    tail = read_ahead->tail;
+    head = __atomic_load_n (&read_ahead->head, __ATOMIC_SEQ_CST);
+
+    offset = tail % read_ahead->ring_size;
+    len = head - tail;
+
+    if (offset + len > read_ahead->ring_size)
+    {
+        len = read_ahead->ring_size - offset;
+    }
+
+    *data = read_ahead->ring + offset;
+
+    return (len > UINT32_MAX) ? UINT32_MAX : (unsigned int)len;
+}
+
+void release_read_ahead (READ_AHEAD* read_ahead, unsigned int len)
+{
+    unsigned long long tail;
+
+    tail = read_ahead->tail;
+
+    __atomic_store_n (&read_ahead->tail, tail + len, __ATOMIC_SEQ_CST);
+
+    // prefetch thread 가 가득 찬 ring 을 보고 잠들었을 수 있다.
+    if (__atomic_load_n (&read_ahead->head, __ATOMIC_SEQ_CST) - tail == read_ahead->ring_size)
+    {
+        signal_event_fd (read_ahead->space_event_fd);
+    }
+}
+
+/* the caller must look at the ring again after this, the signal may have been for new data */
+void rearm_read_ahead (READ_AHEAD* read_ahead)
+{
+    drain_event_fd (read_ahead->data_event_fd);
+}
+
+/* waits until the ring is not empty or the prefetch thread has finished */
+
+int wait_read_ahead (READ_AHEAD* read_ahead, int timeout_msecs, bool* is_ready)
+{
+    struct pollfd poll_fd;
+    int retval;
+
+    poll_fd.fd      = read_ahead->data_event_fd;
+    poll_fd.events  = POLLIN;
+    poll_fd.revents = 0;
+
+    *is_ready = false;
+
+    retval = poll (&poll_fd, 1, timeout_msecs);
+
+    if (retval == -1)
+    {
+        if (errno == EINTR)
+        {
+            goto end;
+        }
+
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+    else if (retval == 0)
+    {
+        /* timeout */
+        goto end;
+    }
+
+    drain_event_fd (read_ahead->data_event_fd);
+
+    *is_ready = true;
+
+end:
+
+    return SUCCESS;
+
+error:
+
+    return FAILURE;
+}
+
+READ_AHEAD_STATE get_read_ahead_state (READ_AHEAD* read_ahead)
+{
+    return __atomic_load_n (&read_ahead->state, __ATOMIC_SEQ_CST);
+}
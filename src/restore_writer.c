@@ -0,0 +1,833 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include "restore_writer.h"
+
+/*
+ * restore writer
+ *
+ * write_queue_depth 가 설정되면 RESTORE_TO_FILE 의 cubrid_restore_write () 는 data 를 slot 에 복사하고
+ * io_uring 에 write 를 건 뒤 바로 return 한다. (slot 이 모두 사용 중이면 하나가 끝날 때까지 기다린다.)
+ * write 는 각자의 file offset 으로 걸리므로 끝나는 순서와 관계없이 file 의 내용은 같다.
+ *
+ * io_uring 을 사용할 수 없거나 COOP_TASKRUN 이 없는 kernel (linux 5.19 이전, 또는 seccomp 로 막힌 환경) 에서는
+ * async_io worker thread 가 순서대로 pwrite () 하고 eventfd 로 완료를 알린다.
+ *
+ * direct_io_size 가 설정되면 restore file 을 O_DIRECT 로 열고, data 를 aligned slot 에 direct_io_size 만큼
+ * 모아서 쓴다. 마지막 block 은 0 으로 채워서 쓴 뒤 cubrid_restore_end () 에서 ftruncate () 로 잘라낸다.
+ *
+ * 실패한 write 는 다음 cubrid_restore_write () 또는 cubrid_restore_end () 가 return 한다.
+ * cubrid_restore_end () 는 모든 write 가 끝난 뒤에 restore file 을 닫는다.
+ */
+
+static
+int io_uring_setup (unsigned int entries, struct io_uring_params* params)
+{
+#ifdef SYS_io_uring_setup
+    return (int)syscall (SYS_io_uring_setup, entries, params);
+#else
+    errno = ENOSYS;
+
+    return -1;
+#endif
+}
+
+static
+int io_uring_enter (int ring_fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+#ifdef SYS_io_uring_enter
+    return (int)syscall (SYS_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+#else
+    errno = ENOSYS;
+
+    return -1;
+#endif
+}
+
+static
+int io_uring_register (int ring_fd, unsigned int opcode, void* arg, unsigned int nr_args)
+{
+#ifdef SYS_io_uring_register
+    return (int)syscall (SYS_io_uring_register, ring_fd, opcode, arg, nr_args);
+#else
+    errno = ENOSYS;
+
+    return -1;
+#endif
+}
+
+static
+int setup_io_uring (RESTORE_WRITER* restore_writer)
+{
+    struct io_uring_params params;
+    char* sq_ring;
+    char* cq_ring;
+
+    int state = 0;
+
+    memset (&params, 0, sizeof (params));
+
+    /*
+     * 기본 설정에서는 write 가 끝날 때마다 kernel 이 cubrid_restore_write () 를 호출한 thread 를 깨워서
+     * 그 thread 의 epoll_wait () 등이 EINTR 로 return 한다.
+     * COOP_TASKRUN (linux 5.19) 이면 완료 처리를 미뤄 두고 sq flags 에 IORING_SQ_TASKRUN 으로 알린다.
+     * COOP_TASKRUN 이 없는 kernel (EINVAL) 에서는 caller 의 event loop 를 깨우지 않도록 io_uring 을 쓰지 않는다.
+     */
+    params.flags = IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG;
+
+    restore_writer->ring_fd = io_uring_setup (restore_writer->queue_depth, &params);
+
+    if (restore_writer->ring_fd == -1)
+    {
+        goto error;
+    }
+
+    state = 1;
+
+    restore_writer->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof (unsigned int);
+    restore_writer->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+
+    // IORING_FEAT_SINGLE_MMAP (linux 5.4) 이면 sq ring 과 cq ring 을 한 번에 map 한다.
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (restore_writer->cq_ring_size > restore_writer->sq_ring_size)
+        {
+            restore_writer->sq_ring_size = restore_writer->cq_ring_size;
+        }
+
+        restore_writer->cq_ring_size = 0;
+    }
+
+    restore_writer->sq_ring = mmap (NULL, restore_writer->sq_ring_size, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, restore_writer->ring_fd, IORING_OFF_SQ_RING);
+
+    if (restore_writer->sq_ring == MAP_FAILED)
+    {
+        goto error;
+    }
+
+    state = 2;
+
+    if (IS_ZERO (restore_writer->cq_ring_size))
+    {
+        restore_writer->cq_ring = restore_writer->sq_ring;
+    }
+    else
+    {
+        restore_writer->cq_ring = mmap (NULL, restore_writer->cq_ring_size, PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE, restore_writer->ring_fd, IORING_OFF_CQ_RING);
+
+        if (restore_writer->cq_ring == MAP_FAILED)
+        {
+            goto error;
+        }
+    }
+
+    state = 3;
+
+    restore_writer->sqes_size = params.sq_entries * sizeof (struct io_uring_sqe);
+
+    restore_writer->sqes = (struct io_uring_sqe *)mmap (NULL, restore_writer->sqes_size, PROT_READ | PROT_WRITE,
+                                                        MAP_SHARED | MAP_POPULATE, restore_writer->ring_fd, IORING_OFF_SQES);
+
+    if (restore_writer->sqes == MAP_FAILED)
+    {
+        goto error;
+    }
+
+    state = 4;
+
+    if (-1 == io_uring_register (restore_writer->ring_fd, IORING_REGISTER_EVENTFD, &restore_writer->event_fd, 1))
+    {
+        goto error;
+    }
+
+    sq_ring = (char *)restore_writer->sq_ring;
+    cq_ring = (char *)restore_writer->cq_ring;
+
+    restore_writer->sq_flags = (unsigned int *)(sq_ring + params.sq_off.flags);
+    restore_writer->sq_tail  = (unsigned int *)(sq_ring + params.sq_off.tail);
+    restore_writer->sq_mask  = (unsigned int *)(sq_ring + params.sq_off.ring_mask);
+    restore_writer->sq_array = (unsigned int *)(sq_ring + params.sq_off.array);
+    restore_writer->cq_head  = (unsigned int *)(cq_ring + params.cq_off.head);
+    restore_writer->cq_tail  = (unsigned int *)(cq_ring + params.cq_off.tail);
+    restore_writer->cq_mask  = (unsigned int *)(cq_ring + params.cq_off.ring_mask);
+    restore_writer->cqes     = (struct io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 4:
+            munmap (restore_writer->sqes, restore_writer->sqes_size);
+        case 3:
+            if (restore_writer->cq_ring != restore_writer->sq_ring)
+            {
+                munmap (restore_writer->cq_ring, restore_writer->cq_ring_size);
+            }
+        case 2:
+            munmap (restore_writer->sq_ring, restore_writer->sq_ring_size);
+        case 1:
+            close (restore_writer->ring_fd);
+            restore_writer->ring_fd = -1;
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+static
+void cleanup_io_uring (RESTORE_WRITER* restore_writer)
+{
+    munmap (restore_writer->sqes, restore_writer->sqes_size);
+
+    if (restore_writer->cq_ring != restore_writer->sq_ring)
+    {
+        munmap (restore_writer->cq_ring, restore_writer->cq_ring_size);
+    }
+
+    munmap (restore_writer->sq_ring, restore_writer->sq_ring_size);
+
+    close (restore_writer->ring_fd);
+}
+
+/* writes what is left of the slot at its own offset */
+static
+int submit_io_uring (RESTORE_WRITER* restore_writer, unsigned int slot_index)
+{
+    WRITE_SLOT* slot = &restore_writer->slots[slot_index];
+    struct io_uring_sqe* sqe;
+    unsigned int sq_tail;
+    unsigned int index;
+    int retval;
+
+    slot->iov.iov_base = slot->buffer + slot->written;
+    slot->iov.iov_len  = slot->data_len - slot->written;
+
+    /* sq tail 은 이 thread 만 쓴다. */
+    sq_tail = *restore_writer->sq_tail;
+    index   = sq_tail & *restore_writer->sq_mask;
+
+    sqe = &restore_writer->sqes[index];
+
+    memset (sqe, 0, sizeof (struct io_uring_sqe));
+
+    sqe->opcode    = IORING_OP_WRITEV;
+    sqe->fd        = restore_writer->restore_fd;
+    sqe->addr      = (unsigned long)&slot->iov;
+    sqe->len       = 1;
+    sqe->off       = slot->offset + slot->written;
+    sqe->user_data = slot_index;
+
+    restore_writer->sq_array[index] = index;
+
+    __atomic_store_n (restore_writer->sq_tail, sq_tail + 1, __ATOMIC_RELEASE);
+
+    do
+    {
+        retval = io_uring_enter (restore_writer->ring_fd, 1, 0, 0);
+    } while (retval == -1 && errno == EINTR);
+
+    if (retval != 1)
+    {
+        /*
+         * kernel 이 sqe 를 가져가지 않았으므로 (SQPOLL 이 아니면 sq head 는 enter 안에서만 움직인다)
+         * tail 을 되돌려 다음 submit 이 이 sqe 를 다시 내보내지 않도록 한다.
+         */
+        __atomic_store_n (restore_writer->sq_tail, sq_tail, __ATOMIC_RELEASE);
+
+        PRINT_LOG_ERR (ERR_INFO);
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+static
+int write_slot_data (void* handle, ASYNC_IO_ENTRY* entry)
+{
+    RESTORE_WRITER* restore_writer = (RESTORE_WRITER *)handle;
+    WRITE_SLOT* slot = &restore_writer->slots[(uintptr_t)entry->user_data];
+    unsigned int written = slot->written;
+    ssize_t write_size;
+
+    while (written < slot->data_len)
+    {
+        write_size = pwrite (restore_writer->restore_fd, slot->buffer + written,
+                             slot->data_len - written, slot->offset + written);
+
+        if (write_size == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            PRINT_LOG_ERR (ERR_INFO);
+            return -errno;
+        }
+        else if (IS_ZERO (write_size))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            return -ENOSPC;
+        }
+
+        written += write_size;
+    }
+
+    /* slot->written 은 complete_slot () 이 갱신한다. */
+    entry->data_len = written - slot->written;
+
+    return SUCCESS;
+}
+
+static
+int submit_slot (RESTORE_WRITER* restore_writer, unsigned int slot_index)
+{
+    WRITE_SLOT* slot = &restore_writer->slots[slot_index];
+    ASYNC_IO_ENTRY entry;
+
+    if (restore_writer->use_io_uring == true)
+    {
+        return submit_io_uring (restore_writer, slot_index);
+    }
+
+    entry.buffer       = slot->buffer;
+    entry.buffer_size  = slot->data_len;
+    entry.data_len     = 0;
+    entry.backup_level = 0;
+    entry.result       = FAILURE;
+    entry.user_data    = (void *)(uintptr_t)slot_index;
+
+    /* in flight 인 write 는 queue_depth (<= MAX_ASYNC_IO_DEPTH) 를 넘지 않으므로 sq 는 넘치지 않는다. */
+    return submit_async_io (restore_writer->async_io, &entry);
+}
+
+/* res: bytes written or -errno */
+static
+void complete_slot (RESTORE_WRITER* restore_writer, unsigned int slot_index, int res)
+{
+    WRITE_SLOT* slot = &restore_writer->slots[slot_index];
+
+    if (res > 0)
+    {
+        slot->written += res;
+
+        if (slot->written < slot->data_len)
+        {
+            /* short write, 남은 부분을 다시 건다. */
+            if (IS_SUCCESS (submit_slot (restore_writer, slot_index)))
+            {
+                return;
+            }
+
+            res = -EIO;
+        }
+    }
+    else if (IS_ZERO (res))
+    {
+        res = -ENOSPC;
+    }
+
+    if (res < 0 && IS_ZERO (restore_writer->write_errno))
+    {
+        restore_writer->write_errno = -res;
+
+        PRINT_LOG_ERR (ERR_INFO);
+        PRINT_LOG_INFO ("restore write failed, offset => %lld, errno => %d\n", slot->offset, -res);
+    }
+
+    restore_writer->free_slots[restore_writer->free_count ++] = slot_index;
+}
+
+/* 끝난 write 를 모두 거둔다. is_wait 이면 하나 이상 끝날 때까지 기다린다. */
+static
+int reap_slots (RESTORE_WRITER* restore_writer, bool is_wait)
+{
+    CUBRID_IO_COMPLETION completions[MAX_ASYNC_IO_DEPTH];
+    struct io_uring_cqe* cqe;
+    unsigned int free_count = restore_writer->free_count;
+    unsigned int cq_head;
+    unsigned int count;
+    unsigned int i;
+
+    // 완료 통지를 먼저 비운 뒤에 확인해야 이후의 완료가 event_fd 를 다시 깨운다.
+    drain_event_fd (restore_writer->event_fd);
+
+    if (restore_writer->use_io_uring == false)
+    {
+        if (IS_FAILURE (reap_async_io (restore_writer->async_io, completions, MAX_ASYNC_IO_DEPTH, is_wait == true ? -1 : 0, &count)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            return FAILURE;
+        }
+
+        for (i = 0; i < count; i ++)
+        {
+            complete_slot (restore_writer, (uintptr_t)completions[i].user_data,
+                           IS_SUCCESS (completions[i].result) ? (int)completions[i].data_len : completions[i].result);
+        }
+
+        return SUCCESS;
+    }
+
+    while (1)
+    {
+        // 미뤄 둔 완료 처리가 있으면 kernel 에 들어가서 cq 에 넣게 한다.
+        if (__atomic_load_n (restore_writer->sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_TASKRUN)
+        {
+            io_uring_enter (restore_writer->ring_fd, 0, 0, IORING_ENTER_GETEVENTS);
+        }
+
+        cq_head = *restore_writer->cq_head;
+
+        while (cq_head != __atomic_load_n (restore_writer->cq_tail, __ATOMIC_ACQUIRE))
+        {
+            cqe = &restore_writer->cqes[cq_head & *restore_writer->cq_mask];
+
+            complete_slot (restore_writer, (unsigned int)cqe->user_data, cqe->res);
+
+            cq_head ++;
+        }
+
+        __atomic_store_n (restore_writer->cq_head, cq_head, __ATOMIC_RELEASE);
+
+        // short write 를 다시 건 경우에는 slot 이 늘지 않았을 수 있다.
+        if (is_wait == false || restore_writer->free_count != free_count)
+        {
+            break;
+        }
+
+        if (-1 == io_uring_enter (restore_writer->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) && errno != EINTR)
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            return FAILURE;
+        }
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * 빈 slot 이 생길 때까지 기다린다. (is_wait 가 아니면 기다리지 않고 SUCCESS_WOULDBLOCK 을 return 한다.)
+ * 앞서 실패한 write 가 있으면 FAILURE 를 return 한다.
+ */
+static
+int wait_free_slot (RESTORE_WRITER* restore_writer, bool is_wait)
+{
+    if (IS_ZERO (restore_writer->free_count))
+    {
+        if (IS_FAILURE (reap_slots (restore_writer, is_wait)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            return FAILURE;
+        }
+    }
+
+    if (IS_NOT_ZERO (restore_writer->write_errno))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        return FAILURE;
+    }
+
+    if (IS_ZERO (restore_writer->free_count))
+    {
+        return SUCCESS_WOULDBLOCK;
+    }
+
+    return SUCCESS;
+}
+
+/* 모은 data 를 쓰기 시작한다. O_DIRECT 이면 마지막 block 의 나머지를 0 으로 채워서 쓴다. */
+static
+int submit_staging_slot (RESTORE_WRITER* restore_writer)
+{
+    unsigned int slot_index = restore_writer->staging_slot;
+    WRITE_SLOT* slot = &restore_writer->slots[slot_index];
+    unsigned int aligned_len;
+
+    if (restore_writer->is_direct_io == true)
+    {
+        aligned_len = (slot->data_len + DIRECT_IO_ALIGN - 1) & ~(DIRECT_IO_ALIGN - 1);
+
+        memset (slot->buffer + slot->data_len, 0, aligned_len - slot->data_len);
+
+        slot->data_len = aligned_len;
+    }
+
+    restore_writer->staging_slot = -1;
+
+    if (IS_FAILURE (submit_slot (restore_writer, slot_index)))
+    {
+        restore_writer->free_slots[restore_writer->free_count ++] = slot_index;
+
+        PRINT_LOG_ERR (ERR_INFO);
+        return FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/* extent_size 만큼 모일 때마다 쓴다. */
+static
+int stage_restore_write (RESTORE_WRITER* restore_writer, char* buffer, unsigned int data_len, bool is_wait, unsigned int* queued)
+{
+    WRITE_SLOT* slot;
+    unsigned int copy_len;
+    int retval;
+
+    while (*queued < data_len)
+    {
+        if (restore_writer->staging_slot == -1)
+        {
+            retval = wait_free_slot (restore_writer, is_wait);
+
+            if (retval == FAILURE)
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                return FAILURE;
+            }
+            else if (retval == SUCCESS_WOULDBLOCK)
+            {
+                break;
+            }
+
+            restore_writer->staging_slot = restore_writer->free_slots[-- restore_writer->free_count];
+
+            slot = &restore_writer->slots[restore_writer->staging_slot];
+
+            slot->data_len = 0;
+            slot->written  = 0;
+            slot->offset   = restore_writer->write_offset;
+        }
+
+        slot = &restore_writer->slots[restore_writer->staging_slot];
+
+        copy_len = restore_writer->extent_size - slot->data_len;
+
+        if (copy_len > data_len - *queued)
+        {
+            copy_len = data_len - *queued;
+        }
+
+        memcpy (slot->buffer + slot->data_len, buffer + *queued, copy_len);
+
+        slot->data_len += copy_len;
+        *queued        += copy_len;
+
+        restore_writer->write_offset += copy_len;
+
+        if (slot->data_len == restore_writer->extent_size)
+        {
+            if (IS_FAILURE (submit_staging_slot (restore_writer)))
+            {
+                PRINT_LOG_ERR (ERR_INFO);
+                return FAILURE;
+            }
+        }
+    }
+
+    return IS_ZERO (*queued) ? SUCCESS_WOULDBLOCK : SUCCESS;
+}
+
+/*
+ * data 를 slot 에 복사하고 write 를 건다. 복사한 길이는 *queued 에 담는다.
+ * 빈 slot 이 없으면 is_wait 일 때는 하나가 끝날 때까지 기다리고,
+ * 아니면 그때까지 복사한 만큼만 받는다. (하나도 받지 못했으면 SUCCESS_WOULDBLOCK)
+ */
+int queue_restore_write (RESTORE_WRITER* restore_writer, void* buffer, unsigned int data_len, bool is_wait, unsigned int* queued)
+{
+    WRITE_SLOT* slot;
+    unsigned int slot_index;
+    char* slot_buffer;
+    int retval;
+
+    *queued = 0;
+
+    if (IS_ZERO (data_len))
+    {
+        return SUCCESS;
+    }
+
+    if (restore_writer->extent_size > 0)
+    {
+        return stage_restore_write (restore_writer, (char *)buffer, data_len, is_wait, queued);
+    }
+
+    retval = wait_free_slot (restore_writer, is_wait);
+
+    if (retval != SUCCESS)
+    {
+        /* FAILURE or SUCCESS_WOULDBLOCK */
+        return retval;
+    }
+
+    slot_index = restore_writer->free_slots[restore_writer->free_count - 1];
+    slot = &restore_writer->slots[slot_index];
+
+    if (slot->capacity < data_len)
+    {
+        slot_buffer = (char *)realloc (slot->buffer, data_len);
+
+        if (IS_NULL (slot_buffer))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            return FAILURE;
+        }
+
+        slot->buffer   = slot_buffer;
+        slot->capacity = data_len;
+    }
+
+    memcpy (slot->buffer, buffer, data_len);
+
+    slot->data_len = data_len;
+    slot->written  = 0;
+    slot->offset   = restore_writer->write_offset;
+
+    if (IS_FAILURE (submit_slot (restore_writer, slot_index)))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        return FAILURE;
+    }
+
+    restore_writer->free_count --;
+    restore_writer->write_offset += data_len;
+
+    *queued = data_len;
+
+    return SUCCESS;
+}
+
+int start_restore_writer (RESTORE_HANDLE* restore_handle)
+{
+    RESTORE_WRITER* restore_writer;
+    unsigned int i;
+
+    int state = 0;
+
+    restore_writer = (RESTORE_WRITER *)malloc (sizeof (RESTORE_WRITER));
+
+    if (IS_NULL (restore_writer))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 1;
+
+    restore_writer->restore_fd   = restore_handle->restore_fd;
+    restore_writer->queue_depth  = backup_mgr->default_restore_option.write_queue_depth;
+    restore_writer->write_offset = restore_handle->write_offset; /* resumed restore file */
+    restore_writer->write_errno  = 0;
+    restore_writer->extent_size  = backup_mgr->default_restore_option.direct_io_size;
+    restore_writer->staging_slot = -1;
+    restore_writer->is_direct_io = (fcntl (restore_writer->restore_fd, F_GETFL) & O_DIRECT) ? true : false;
+    restore_writer->ring_fd      = -1;
+    restore_writer->async_io     = NULL;
+
+    if (IS_ZERO (restore_writer->queue_depth))
+    {
+        restore_writer->queue_depth = DEFAULT_DIRECT_IO_QUEUE_DEPTH;
+    }
+
+    restore_writer->free_count = restore_writer->queue_depth;
+
+    for (i = 0; i < restore_writer->queue_depth; i ++)
+    {
+        restore_writer->slots[i].buffer   = NULL;
+        restore_writer->slots[i].capacity = 0;
+
+        restore_writer->free_slots[i] = restore_writer->queue_depth - 1 - i;
+    }
+
+    state = 2;
+
+    // O_DIRECT 의 buffer 는 DIRECT_IO_ALIGN 에 맞아야 하므로 미리 extent_size 로 할당해 둔다.
+    for (i = 0; i < restore_writer->queue_depth && restore_writer->extent_size > 0; i ++)
+    {
+        if (IS_NOT_ZERO (posix_memalign ((void **)&restore_writer->slots[i].buffer, DIRECT_IO_ALIGN, restore_writer->extent_size)))
+        {
+            restore_writer->slots[i].buffer = NULL;
+
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        restore_writer->slots[i].capacity = restore_writer->extent_size;
+    }
+
+    restore_writer->event_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (restore_writer->event_fd == -1)
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        goto error;
+    }
+
+    state = 3;
+
+    restore_writer->use_io_uring = IS_SUCCESS (setup_io_uring (restore_writer)) ? true : false;
+
+    if (restore_writer->use_io_uring == false)
+    {
+        PRINT_LOG_INFO ("io_uring is not available, errno => %d, restore writes fall back to a thread\n", errno);
+
+        /* 완료는 async_io 의 cq_event_fd 로 통지된다. */
+        close (restore_writer->event_fd);
+
+        restore_writer->event_fd = -1;
+
+        if (IS_FAILURE (start_async_io (restore_writer, write_slot_data, &restore_writer->async_io)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            goto error;
+        }
+
+        restore_writer->event_fd = restore_writer->async_io->cq_event_fd;
+    }
+
+    restore_handle->restore_writer = restore_writer;
+
+    return SUCCESS;
+
+error:
+
+    switch (state)
+    {
+        case 3:
+            if (restore_writer->event_fd != -1)
+            {
+                close (restore_writer->event_fd);
+            }
+        case 2:
+            for (i = 0; i < restore_writer->queue_depth; i ++)
+            {
+                free (restore_writer->slots[i].buffer);
+            }
+        case 1:
+            free (restore_writer);
+        default:
+            break;
+    }
+
+    return FAILURE;
+}
+
+/*
+ * 걸려 있는 write 가 모두 끝날 때까지 기다린다. 모으는 중인 slot 은 그대로 두므로
+ * 그 앞까지, 즉 *synced_offset 까지 restore_fd 에 쓰인 것이 된다.
+ */
+int sync_restore_writer (RESTORE_WRITER* restore_writer, long long* synced_offset)
+{
+    unsigned int idle_count = (restore_writer->staging_slot != -1) ? 1 : 0;
+
+    while (restore_writer->free_count + idle_count < restore_writer->queue_depth)
+    {
+        if (IS_FAILURE (reap_slots (restore_writer, true)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+            return FAILURE;
+        }
+    }
+
+    if (IS_NOT_ZERO (restore_writer->write_errno))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+        return FAILURE;
+    }
+
+    if (restore_writer->staging_slot != -1)
+    {
+        *synced_offset = restore_writer->slots[restore_writer->staging_slot].offset;
+    }
+    else
+    {
+        *synced_offset = restore_writer->write_offset;
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * 걸려 있는 write 가 모두 끝날 때까지 기다린 뒤 writer 를 정리한다.
+ * restore file 을 닫기 전에 호출해야 하며, 실패한 write 가 있었으면 FAILURE 를 return 한다.
+ */
+int stop_restore_writer (RESTORE_HANDLE* restore_handle)
+{
+    RESTORE_WRITER* restore_writer = restore_handle->restore_writer;
+    int retval = SUCCESS;
+    unsigned int i;
+
+    if (IS_NULL (restore_writer))
+    {
+        return SUCCESS;
+    }
+
+    // 모으던 data 를 마저 쓴다.
+    if (restore_writer->staging_slot != -1)
+    {
+        if (IS_FAILURE (submit_staging_slot (restore_writer)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            retval = FAILURE;
+        }
+    }
+
+    while (restore_writer->free_count < restore_writer->queue_depth)
+    {
+        if (IS_FAILURE (reap_slots (restore_writer, true)))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            retval = FAILURE;
+            break;
+        }
+    }
+
+    if (IS_NOT_ZERO (restore_writer->write_errno))
+    {
+        PRINT_LOG_ERR (ERR_INFO);
+
+        retval = FAILURE;
+    }
+    else if (restore_writer->is_direct_io == true && IS_NOT_ZERO (restore_writer->write_offset % DIRECT_IO_ALIGN))
+    {
+        /* 마지막 block 을 채운 0 을 잘라낸다. */
+        if (-1 == ftruncate (restore_writer->restore_fd, restore_writer->write_offset))
+        {
+            PRINT_LOG_ERR (ERR_INFO);
+
+            retval = FAILURE;
+        }
+    }
+
+    if (restore_writer->use_io_uring == true)
+    {
+        cleanup_io_uring (restore_writer);
+
+        close (restore_writer->event_fd);
+    }
+    else
+    {
+        stop_async_io (&restore_writer->async_io);
+    }
+
+    for (i = 0; i < restore_writer->queue_depth; i ++)
+    {
+        free (restore_writer->slots[i].buffer);
+    }
+
+    free (restore_writer);
+
+    restore_handle->restore_writer = NULL;
+
+    return retval;
+}
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <poll.h>
 #include "cubrid_backup_api.h"
 
 CUBRID_BACKUP_INFO cub_backup_info;
@@ -162,6 +163,260 @@ void call_cubrid_backup_end_x_2 (void)
     cubrid_backup_finalize ();
 }
 
+void call_cubrid_backup_cancel (void)
+{
+    char backup_data_buffer[4096];
+    int backup_data_size = 0;
+    int backup_result;
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_begin (&cub_backup_info, &cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_read (cub_backup_handle, backup_data_buffer, 4096, &backup_data_size))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_cancel (cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    // cancel 된 backup 은 끝까지 읽을 수 없다.
+    do
+    {
+        backup_result = cubrid_backup_read (cub_backup_handle, backup_data_buffer, 4096, &backup_data_size);
+    } while (1 == backup_result);
+
+    if (-1 != backup_result)
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_end (cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_cancel (cub_backup_handle))
+    {
+        printf ("[OK] %s\n", __func__);
+    }
+    else
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    cubrid_backup_finalize ();
+}
+
+void call_cubrid_backup_set_read_lowat (void)
+{
+    static char backup_data_buffer[65536];
+    int backup_data_size = 0;
+    int backup_result;
+    int short_read_count = 0;
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_begin (&cub_backup_info, &cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_set_read_lowat (cub_backup_handle, sizeof (backup_data_buffer)))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    // backup 의 마지막 조각을 제외하면 항상 buffer 를 가득 채워서 return 한다.
+    do
+    {
+        backup_result = cubrid_backup_read (cub_backup_handle, backup_data_buffer, sizeof (backup_data_buffer), &backup_data_size);
+
+        if (1 == backup_result && backup_data_size != sizeof (backup_data_buffer))
+        {
+            short_read_count ++;
+        }
+    } while (1 == backup_result);
+
+    if (0 != backup_result || short_read_count > 1)
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_end (cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_set_read_lowat (cub_backup_handle, 0))
+    {
+        printf ("[OK] %s\n", __func__);
+    }
+    else
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    cubrid_backup_finalize ();
+}
+
+void call_cubrid_backup_set_pipe_size (void)
+{
+    static char backup_data_buffer[65536];
+    int backup_data_size = 0;
+    int backup_result;
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_begin (&cub_backup_info, &cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    // 0 or > 0
+    if (-1 != cubrid_backup_set_pipe_size (cub_backup_handle, -5))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_set_pipe_size (cub_backup_handle, 1024 * 1024))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    do
+    {
+        backup_result = cubrid_backup_read (cub_backup_handle, backup_data_buffer, sizeof (backup_data_buffer), &backup_data_size);
+    } while (1 == backup_result);
+
+    if (0 != backup_result)
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_end (cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_set_pipe_size (cub_backup_handle, 0))
+    {
+        printf ("[OK] %s\n", __func__);
+    }
+    else
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    cubrid_backup_finalize ();
+}
+
+void call_cubrid_backup_read_nb (void)
+{
+    static char backup_data_buffer[65536];
+    struct pollfd poll_fd;
+    unsigned int backup_data_size = 0;
+    long long total_backup_data_size = 0;
+    int backup_result;
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_begin (&cub_backup_info, &cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    poll_fd.fd     = cubrid_backup_get_pollfd (cub_backup_handle);
+    poll_fd.events = POLLIN;
+
+    if (-1 == poll_fd.fd)
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    // 2: 지금은 읽을 data 가 없으니 poll fd 가 readable 이 될 때까지 기다린다.
+    do
+    {
+        backup_result = cubrid_backup_read_nb (cub_backup_handle, backup_data_buffer, sizeof (backup_data_buffer), &backup_data_size);
+
+        if (2 == backup_result && 1 != poll (&poll_fd, 1, 10000))
+        {
+            printf ("[NOK] %s\n", __func__);
+            exit (1);
+        }
+
+        if (2 != backup_result)
+        {
+            total_backup_data_size += backup_data_size;
+        }
+    } while (1 == backup_result || 2 == backup_result);
+
+    if (0 != backup_result || 0 == total_backup_data_size)
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_end (cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_get_pollfd (cub_backup_handle))
+    {
+        printf ("[OK] %s\n", __func__);
+    }
+    else
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    cubrid_backup_finalize ();
+}
+
 void call_cubrid_backup_finalize_x_2 (void)
 {
     if (-1 == cubrid_backup_initialize ())
@@ -215,5 +470,17 @@ int main (int argc, char *argv[])
 
     call_cubrid_backup_finalize_x_2 ();
 
+    /* test - cancel a running backup */
+    call_cubrid_backup_cancel ();
+
+    /* test - fill the whole buffer on each read */
+    call_cubrid_backup_set_read_lowat ();
+
+    /* test - set the fifo capacity of one handle */
+    call_cubrid_backup_set_pipe_size ();
+
+    /* test - read from an event loop without blocking */
+    call_cubrid_backup_read_nb ();
+
     return 0;
 }
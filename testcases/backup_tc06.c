@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include "cubrid_backup_api.h"
+
+#define BUFFER_SIZE  (1024 * 1024)
+#define BUFFER_COUNT (4)
+
+static char backup_data_buffer[BUFFER_SIZE];
+
+typedef struct sink_ctx SINK_CTX;
+struct sink_ctx
+{
+    int backup_fd;
+    long long total_backup_data_size;
+    int stop_after; // stop the backup after this many chunks, -1: never
+};
+
+void usage ()
+{
+    printf ("./backup_tc06 [DB_NAME] [BACKUP_LEVEL] [BACKUP_FILE_PATH]\n\n");
+    printf ("ex)\n");
+    printf ("backup (full)    ==> ./backup_tc06 demodb 0 ./backup_dir/demodb_bk0v000\n");
+    printf ("       (level 1) ==> ./backup_tc06 demodb 1 ./backup_dir/demodb_bk1v000\n");
+    printf ("       (level 2) ==> ./backup_tc06 demodb 2 ./backup_dir/demodb_bk2v000\n");
+}
+
+void set_backup_info (CUBRID_BACKUP_INFO *backup_info, char *db_name, char *backup_level)
+{
+    backup_info->backup_level   = atoi (backup_level);
+    backup_info->remove_archive = -1;
+    backup_info->sa_mode        = -1;
+    backup_info->no_check       = -1;
+    backup_info->compress       = -1;
+    backup_info->db_name        = db_name;
+}
+
+double get_elapsed_secs (struct timespec *start_time)
+{
+    struct timespec end_time;
+
+    clock_gettime (CLOCK_MONOTONIC, &end_time);
+
+    return (end_time.tv_sec - start_time->tv_sec) + (end_time.tv_nsec - start_time->tv_nsec) / 1e9;
+}
+
+// the same consumer for both modes: write to the archive and make it durable
+int archive_backup_data (SINK_CTX *sink_ctx, const void *data, unsigned int data_len)
+{
+    if (data_len != write (sink_ctx->backup_fd, data, data_len))
+    {
+        return -1;
+    }
+
+    fdatasync (sink_ctx->backup_fd);
+
+    sink_ctx->total_backup_data_size += data_len;
+
+    return 0;
+}
+
+int sink_cb (void *ctx, const void *data, unsigned int data_len)
+{
+    SINK_CTX *sink_ctx = (SINK_CTX *)ctx;
+
+    if (sink_ctx->stop_after == 0)
+    {
+        return -1;
+    }
+
+    sink_ctx->stop_after --;
+
+    return archive_backup_data (sink_ctx, data, data_len);
+}
+
+void backup_with_read_loop (CUBRID_BACKUP_INFO *backup_info, char *backup_file_path)
+{
+    void *cub_backup_handle = NULL;
+    SINK_CTX sink_ctx;
+    struct timespec start_time;
+    unsigned int backup_data_size = 0;
+    int backup_result;
+
+    sink_ctx.backup_fd = open (backup_file_path, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    sink_ctx.total_backup_data_size = 0;
+    sink_ctx.stop_after = -1;
+
+    if (sink_ctx.backup_fd == -1)
+    {
+        printf ("[NOK] failed to open backup file\n");
+        exit (1);
+    }
+
+    clock_gettime (CLOCK_MONOTONIC, &start_time);
+
+    if (-1 == cubrid_backup_begin (backup_info, &cub_backup_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_begin ()\n");
+        exit (1);
+    }
+
+    do
+    {
+        backup_result = cubrid_backup_read (cub_backup_handle, backup_data_buffer, BUFFER_SIZE, &backup_data_size);
+        if (-1 == backup_result)
+        {
+            printf ("[NOK] failed the execution of cubrid_backup_read ()\n");
+            exit (1);
+        }
+
+        if (backup_data_size != 0 && -1 == archive_backup_data (&sink_ctx, backup_data_buffer, backup_data_size))
+        {
+            printf ("[NOK] failed to write backup file\n");
+            exit (1);
+        }
+    } while (1 == backup_result); // 0: backup end, 1: read more backup data
+
+    if (-1 == cubrid_backup_end (cub_backup_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_end ()\n");
+        exit (1);
+    }
+
+    close (sink_ctx.backup_fd);
+
+    printf ("[%s] cubrid_backup_read () loop, backup_data_size ==> %lld, %.3f sec\n",
+            (sink_ctx.total_backup_data_size != 0) ? "OK" : "NOK",
+            sink_ctx.total_backup_data_size,
+            get_elapsed_secs (&start_time));
+}
+
+void backup_with_run (CUBRID_BACKUP_INFO *backup_info, char *backup_file_path)
+{
+    void *cub_backup_handle = NULL;
+    SINK_CTX sink_ctx;
+    struct timespec start_time;
+
+    sink_ctx.backup_fd = open (backup_file_path, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    sink_ctx.total_backup_data_size = 0;
+    sink_ctx.stop_after = -1;
+
+    if (sink_ctx.backup_fd == -1)
+    {
+        printf ("[NOK] failed to open backup file\n");
+        exit (1);
+    }
+
+    clock_gettime (CLOCK_MONOTONIC, &start_time);
+
+    if (-1 == cubrid_backup_begin (backup_info, &cub_backup_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_begin ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_run (cub_backup_handle, sink_cb, &sink_ctx, BUFFER_SIZE, BUFFER_COUNT))
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_run ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_end (cub_backup_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_end ()\n");
+        exit (1);
+    }
+
+    close (sink_ctx.backup_fd);
+
+    printf ("[%s] cubrid_backup_run (), backup_data_size ==> %lld, %.3f sec\n",
+            (sink_ctx.total_backup_data_size != 0) ? "OK" : "NOK",
+            sink_ctx.total_backup_data_size,
+            get_elapsed_secs (&start_time));
+}
+
+void stop_run_from_sink (CUBRID_BACKUP_INFO *backup_info)
+{
+    void *cub_backup_handle = NULL;
+    SINK_CTX sink_ctx;
+
+    sink_ctx.backup_fd = open ("/dev/null", O_WRONLY);
+    sink_ctx.total_backup_data_size = 0;
+    sink_ctx.stop_after = 1;
+
+    if (-1 == cubrid_backup_begin (backup_info, &cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    // sink_cb 가 -1 을 return 하면 backup 이 중단된다.
+    if (-1 != cubrid_backup_run (cub_backup_handle, sink_cb, &sink_ctx, BUFFER_SIZE, BUFFER_COUNT))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_end (cub_backup_handle))
+    {
+        printf ("[NOK] %s\n", __func__);
+        exit (1);
+    }
+
+    close (sink_ctx.backup_fd);
+
+    printf ("[OK] %s\n", __func__);
+}
+
+int main (int argc, char *argv[])
+{
+    CUBRID_BACKUP_INFO cub_backup_info;
+
+    if (argc != 4)
+    {
+        usage ();
+        exit (1);
+    }
+
+    set_backup_info (&cub_backup_info, argv[1], argv[2]);
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_initialize ()\n");
+        exit (1);
+    }
+
+    backup_with_read_loop (&cub_backup_info, argv[3]);
+    sleep (1);
+
+    stop_run_from_sink (&cub_backup_info);
+    sleep (1);
+
+    // the backup file of the last run is restored by run_test.sh
+    backup_with_run (&cub_backup_info, argv[3]);
+
+    if (-1 == cubrid_backup_finalize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_finalize ()\n");
+        exit (1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "cubrid_backup_api.h"
+
+#define BUFFER_SIZE  (1024 * 1024)
+#define BUFFER_COUNT (8)
+
+static char backup_data_buffers[BUFFER_COUNT][BUFFER_SIZE];
+
+void usage ()
+{
+    printf ("./backup_tc07 [DB_NAME] [BACKUP_LEVEL] [BACKUP_FILE_PATH]\n\n");
+    printf ("ex)\n");
+    printf ("backup (full)    ==> ./backup_tc07 demodb 0 ./backup_dir/demodb_bk0v000\n");
+    printf ("       (level 1) ==> ./backup_tc07 demodb 1 ./backup_dir/demodb_bk1v000\n");
+    printf ("       (level 2) ==> ./backup_tc07 demodb 2 ./backup_dir/demodb_bk2v000\n");
+}
+
+void set_backup_info (CUBRID_BACKUP_INFO *backup_info, char *db_name, char *backup_level)
+{
+    backup_info->backup_level   = atoi (backup_level);
+    backup_info->remove_archive = -1;
+    backup_info->sa_mode        = -1;
+    backup_info->no_check       = -1;
+    backup_info->compress       = -1;
+    backup_info->db_name        = db_name;
+}
+
+// every buffer is posted up front and posted again as soon as it is written out
+void backup_with_submit_read (CUBRID_BACKUP_INFO *backup_info, char *backup_file_path)
+{
+    void *cub_backup_handle = NULL;
+    CUBRID_IO_COMPLETION completions[BUFFER_COUNT];
+    unsigned int backup_data_size = 0;
+    long long total_backup_data_size = 0;
+    int in_flight_count = 0;
+    int is_backup_end = 0;
+    int backup_fd;
+    int count;
+    int i;
+
+    backup_fd = open (backup_file_path, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+
+    if (backup_fd == -1)
+    {
+        printf ("[NOK] failed to open backup file\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_begin (backup_info, &cub_backup_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_begin ()\n");
+        exit (1);
+    }
+
+    for (i = 0; i < BUFFER_COUNT; i ++)
+    {
+        if (0 != cubrid_backup_submit_read (cub_backup_handle, backup_data_buffers[i], BUFFER_SIZE, NULL))
+        {
+            printf ("[NOK] failed the execution of cubrid_backup_submit_read ()\n");
+            exit (1);
+        }
+
+        in_flight_count ++;
+    }
+
+    // the blocking read must not be mixed with the submitted ones
+    if (-1 != cubrid_backup_read (cub_backup_handle, backup_data_buffers[0], BUFFER_SIZE, &backup_data_size))
+    {
+        printf ("[NOK] cubrid_backup_read () after cubrid_backup_submit_read ()\n");
+        exit (1);
+    }
+
+    while (in_flight_count != 0)
+    {
+        count = cubrid_backup_reap (cub_backup_handle, completions, BUFFER_COUNT, -1);
+
+        if (-1 == count)
+        {
+            printf ("[NOK] failed the execution of cubrid_backup_reap ()\n");
+            exit (1);
+        }
+
+        for (i = 0; i < count; i ++)
+        {
+            in_flight_count --;
+
+            if (-1 == completions[i].result)
+            {
+                printf ("[NOK] failed to read backup data\n");
+                exit (1);
+            }
+
+            if (completions[i].data_len != write (backup_fd, completions[i].buffer, completions[i].data_len))
+            {
+                printf ("[NOK] failed to write backup file\n");
+                exit (1);
+            }
+
+            total_backup_data_size += completions[i].data_len;
+
+            if (0 == completions[i].result)
+            {
+                is_backup_end = 1;
+            }
+
+            if (0 == is_backup_end)
+            {
+                if (0 != cubrid_backup_submit_read (cub_backup_handle, completions[i].buffer, BUFFER_SIZE, NULL))
+                {
+                    printf ("[NOK] failed the execution of cubrid_backup_submit_read ()\n");
+                    exit (1);
+                }
+
+                in_flight_count ++;
+            }
+        }
+    }
+
+    if (-1 == cubrid_backup_end (cub_backup_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_end ()\n");
+        exit (1);
+    }
+
+    close (backup_fd);
+
+    printf ("[%s] cubrid_backup_submit_read (), backup_data_size ==> %lld\n",
+            (is_backup_end == 1 && total_backup_data_size != 0) ? "OK" : "NOK",
+            total_backup_data_size);
+}
+
+int main (int argc, char *argv[])
+{
+    CUBRID_BACKUP_INFO cub_backup_info;
+
+    if (argc != 4)
+    {
+        usage ();
+        exit (1);
+    }
+
+    set_backup_info (&cub_backup_info, argv[1], argv[2]);
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_initialize ()\n");
+        exit (1);
+    }
+
+    // the backup file is restored by run_test.sh
+    backup_with_submit_read (&cub_backup_info, argv[3]);
+
+    if (-1 == cubrid_backup_finalize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_finalize ()\n");
+        exit (1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "cubrid_backup_api.h"
+
+#define READ_SIZE        (16 * 1024)
+#define READ_DELAY_USECS (1000)
+
+void usage ()
+{
+    printf ("./backup_tc08 [DB_NAME] [BACKUP_LEVEL] [BACKUP_FILE_PATH]\n\n");
+    printf ("ex)\n");
+    printf ("backup (full)    ==> ./backup_tc08 demodb 0 ./backup_dir/demodb_bk0v000\n");
+    printf ("       (level 1) ==> ./backup_tc08 demodb 1 ./backup_dir/demodb_bk1v000\n");
+    printf ("       (level 2) ==> ./backup_tc08 demodb 2 ./backup_dir/demodb_bk2v000\n");
+    printf ("the backup data is read slowly (%d bytes every %d usecs), so that cubrid backupdb runs ahead of the reader\n",
+            READ_SIZE, READ_DELAY_USECS);
+}
+
+void set_backup_info (CUBRID_BACKUP_INFO *backup_info, char *db_name, char *backup_level)
+{
+    backup_info->backup_level   = atoi (backup_level);
+    backup_info->remove_archive = -1;
+    backup_info->sa_mode        = -1;
+    backup_info->no_check       = -1;
+    backup_info->compress       = -1;
+    backup_info->db_name        = db_name;
+}
+
+int main (int argc, char *argv[])
+{
+    CUBRID_BACKUP_INFO cub_backup_info;
+    void *cub_backup_handle = NULL;
+
+    char backup_data_buffer[READ_SIZE];
+    unsigned int backup_data_size = 0;
+
+    long long total_backup_data_size = 0;
+
+    int  backup_result;
+
+    FILE *backup_fp;
+
+    if (argc != 4)
+    {
+        usage ();
+        exit (1);
+    }
+
+    set_backup_info (&cub_backup_info, argv[1], argv[2]);
+
+    backup_fp = fopen (argv[3], "w+b");
+    if (backup_fp == NULL)
+    {
+        printf ("[NOK] failed to open backup file\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_initialize ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_begin (&cub_backup_info, &cub_backup_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_begin ()\n");
+        exit (1);
+    }
+
+    while (1)
+    {
+        backup_result = cubrid_backup_read (cub_backup_handle, backup_data_buffer, READ_SIZE, &backup_data_size);
+        if (-1 == backup_result)
+        {
+            printf ("[NOK] failed the execution of cubrid_backup_read ()\n");
+            exit (1);
+        }
+
+        if (backup_data_size != 0)
+        {
+            fwrite (backup_data_buffer, 1, backup_data_size, backup_fp);
+
+            total_backup_data_size += backup_data_size;
+        }
+
+        if (0 == backup_result) // 0: backup end, 1: read more backup data
+        {
+            break;
+        }
+
+        // a slow consumer, ex) upload to a remote storage
+        usleep (READ_DELAY_USECS);
+    }
+
+    fclose (backup_fp);
+
+    if (-1 == cubrid_backup_end (cub_backup_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_end ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_finalize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_finalize ()\n");
+        exit (1);
+    }
+
+    if (0 == total_backup_data_size)
+    {
+        printf ("[NOK] backup_data_size ==> %lld\n", total_backup_data_size);
+        exit (1);
+    }
+
+    printf ("[OK] backup_data_size ==> %lld\n", total_backup_data_size);
+
+    return 0;
+}
@@ -138,5 +138,59 @@ else
 	cat $CUBRID/log/cubrid_utility.log >> conf_test_result
 fi
 rm -rf $CUBRID/log/cubrid_utility.log
+sleep 2
+
+cp cubrid_backup.conf $CUBRID/conf/
+sed -i "s/read_ahead_size=0/read_ahead_size=16M/g" $CUBRID/conf/cubrid_backup.conf
+mkdir -p ./backup_dir/11
+./backup_tc01 $db_name 0 ./backup_dir/11/${db_name}_bk0v000 >> conf_test_result 2>&1
+if [ `grep "0 \-l 0 \-\-no\-check \-t 8 \-\-sleep\-msecs=20" $CUBRID/log/cubrid_utility.log | wc -l` -eq 1 ]; then
+        echo "[OK] set cubrid_backup.conf (11)" >> conf_test_result
+else
+        echo "[NOK] set cubrid_backup.conf (11)" >> conf_test_result
+	cat $CUBRID/log/cubrid_utility.log >> conf_test_result
+fi
+rm -rf $CUBRID/log/cubrid_utility.log
+sleep 2
+
+# a slow reader overflows the small ring into the spill file, which must wrap around
+cp cubrid_backup.conf $CUBRID/conf/
+sed -i "s/read_ahead_size=0/read_ahead_size=256K/g" $CUBRID/conf/cubrid_backup.conf
+sed -i "s/spill_size=0/spill_size=1M/g" $CUBRID/conf/cubrid_backup.conf
+mkdir -p ./backup_dir/12
+./backup_tc08 $db_name 0 ./backup_dir/12/${db_name}_bk0v000 >> conf_test_result 2>&1
+spill_bytes=`grep -o "spill_bytes => [0-9]*" $CUBRID/log/cubrid_backup.log | tail -1 | awk '{print $3}'`
+if [ `grep "0 \-l 0 \-\-no\-check \-t 8 \-\-sleep\-msecs=20" $CUBRID/log/cubrid_utility.log | wc -l` -eq 1 ] && [ ${spill_bytes:-0} -gt 1048576 ]; then
+        echo "[OK] set cubrid_backup.conf (12)" >> conf_test_result
+else
+        echo "[NOK] set cubrid_backup.conf (12), spill_bytes ==> ${spill_bytes:-0}" >> conf_test_result
+	cat $CUBRID/log/cubrid_utility.log >> conf_test_result
+fi
+rm -rf $CUBRID/log/cubrid_utility.log
+
+# O_DIRECT restore of a file that ends in the middle of a block
+cp cubrid_backup.conf $CUBRID/conf/
+sed -i "/^\[restore\]/a direct_io_size=4096" $CUBRID/conf/cubrid_backup.conf
+mkdir -p ./restore_dir/13/src
+backup_size=`stat -c %s ./backup_dir/1/${db_name}_bk0v000`
+head -c $(( backup_size / 4096 * 4096 - 1000 )) ./backup_dir/1/${db_name}_bk0v000 > ./restore_dir/13/src/${db_name}_bk0v000
+./restore_tc01 $db_name 0 ./restore_dir/13/src/${db_name}_bk0v000 0 ./restore_dir/13 >> conf_test_result 2>&1
+if [ -z "`cmp ./restore_dir/13/src/${db_name}_bk0v000 ./restore_dir/13/${db_name}_bk0v000 2>&1`" ]; then
+        echo "[OK] set cubrid_backup.conf (13)" >> conf_test_result
+else
+        echo "[NOK] set cubrid_backup.conf (13)" >> conf_test_result
+	ls -l ./restore_dir/13/src/${db_name}_bk0v000 ./restore_dir/13/${db_name}_bk0v000 >> conf_test_result
+fi
+
+# writeback of a resumable restore, killed in the middle and resumed from a checkpoint
+cp cubrid_backup.conf $CUBRID/conf/
+sed -i "/^\[restore\]/a writeback_size=128K" $CUBRID/conf/cubrid_backup.conf
+mkdir -p ./restore_dir/14
+./restore_tc08 $db_name 0 ./backup_dir/1/${db_name}_bk0v000 ./restore_dir/14 >> conf_test_result 2>&1
+if [ $? -eq 0 ] && [ -z "`cmp ./backup_dir/1/${db_name}_bk0v000 ./restore_dir/14/${db_name}_bk0v000 2>&1`" ]; then
+        echo "[OK] set cubrid_backup.conf (14)" >> conf_test_result
+else
+        echo "[NOK] set cubrid_backup.conf (14)" >> conf_test_result
+fi
 
 rm -rf $CUBRID/conf/cubrid_backup.conf
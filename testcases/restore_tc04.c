@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "cubrid_backup_api.h"
+
+#define VOLUME_COUNT (3)
+
+typedef struct volume_writer VOLUME_WRITER;
+struct volume_writer
+{
+    pthread_t thread;
+    int volume_index;
+    long offset;
+    long size;
+    int result;
+};
+
+static CUBRID_RESTORE_INFO cub_restore_info;
+static void *cub_restore_handle = NULL;
+static char *backup_file_path;
+
+void usage ()
+{
+    printf ("./restore_tc04 [DB_NAME] [BACKUP_LEVEL] [BACKUP_FILE_PATH] [RESTORE_PATH]\n\n");
+    printf ("ex)\n");
+    printf ("restore (full) ==> ./restore_tc04 demodb 0 ./backup_dir/demodb_bk0v000 ./restore_dir\n");
+    printf ("the backup file is written as %d volumes (demodb_bk0v000 ~ demodb_bk0v%03d)\n", VOLUME_COUNT, VOLUME_COUNT - 1);
+}
+
+void set_restore_info (CUBRID_RESTORE_INFO *restore_info, char *db_name, char *backup_level, char *restore_path)
+{
+    restore_info->db_name          = db_name;
+    restore_info->backup_level     = atoi (backup_level);
+    restore_info->restore_type     = RESTORE_TO_FILE;
+    restore_info->backup_file_path = restore_path;
+}
+
+// each thread writes its part of the backup file as one volume
+void *write_volume (void *arg)
+{
+    VOLUME_WRITER *volume_writer = (VOLUME_WRITER *)arg;
+    char restore_data_buffer[4096];
+    long remain_size = volume_writer->size;
+    size_t restore_data_size;
+    FILE *backup_fp;
+
+    volume_writer->result = -1;
+
+    backup_fp = fopen (backup_file_path, "r");
+    if (backup_fp == NULL)
+    {
+        return NULL;
+    }
+
+    fseek (backup_fp, volume_writer->offset, SEEK_SET);
+
+    while (remain_size > 0)
+    {
+        restore_data_size = fread (restore_data_buffer, 1, remain_size < 4096 ? remain_size : 4096, backup_fp);
+
+        if (restore_data_size == 0)
+        {
+            fclose (backup_fp);
+            return NULL;
+        }
+
+        if (-1 == cubrid_restore_write_volume (cub_restore_handle, cub_restore_info.backup_level, volume_writer->volume_index,
+                                               restore_data_buffer, restore_data_size))
+        {
+            fclose (backup_fp);
+            return NULL;
+        }
+
+        remain_size -= restore_data_size;
+    }
+
+    fclose (backup_fp);
+
+    volume_writer->result = 0;
+
+    return NULL;
+}
+
+int main (int argc, char *argv[])
+{
+    VOLUME_WRITER volume_writers[VOLUME_COUNT];
+    char restore_data_buffer[4096];
+    long backup_file_size;
+    FILE *backup_fp;
+    int i;
+
+    if (argc != 5)
+    {
+        usage ();
+        exit (1);
+    }
+
+    set_restore_info (&cub_restore_info, argv[1], argv[2], argv[4]);
+
+    backup_file_path = argv[3];
+
+    backup_fp = fopen (backup_file_path, "r");
+    if (backup_fp == NULL)
+    {
+        printf ("[NOK] failed to open backup file\n");
+        exit (1);
+    }
+
+    fseek (backup_fp, 0, SEEK_END);
+    backup_file_size = ftell (backup_fp);
+    fclose (backup_fp);
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_initialize ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_restore_begin (&cub_restore_info, &cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_begin ()\n");
+        exit (1);
+    }
+
+    // out of range volume
+    if (-1 != cubrid_restore_write_volume (cub_restore_handle, cub_restore_info.backup_level, 64, restore_data_buffer, 4096))
+    {
+        printf ("[NOK] cubrid_restore_write_volume () with an invalid volume_index\n");
+        exit (1);
+    }
+
+    for (i = 0; i < VOLUME_COUNT; i ++)
+    {
+        volume_writers[i].volume_index = i;
+        volume_writers[i].offset       = backup_file_size / VOLUME_COUNT * i;
+        volume_writers[i].size         = (i == VOLUME_COUNT - 1) ? backup_file_size - volume_writers[i].offset : backup_file_size / VOLUME_COUNT;
+
+        if (0 != pthread_create (&volume_writers[i].thread, NULL, write_volume, &volume_writers[i]))
+        {
+            printf ("[NOK] failed to create a thread\n");
+            exit (1);
+        }
+    }
+
+    for (i = 0; i < VOLUME_COUNT; i ++)
+    {
+        pthread_join (volume_writers[i].thread, NULL);
+
+        if (-1 == volume_writers[i].result)
+        {
+            printf ("[NOK] failed the execution of cubrid_restore_write_volume (), volume_index ==> %d\n", i);
+            exit (1);
+        }
+    }
+
+    if (-1 == cubrid_restore_end (cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_end ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_finalize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_finalize ()\n");
+        exit (1);
+    }
+
+    printf ("[OK] cubrid_restore_write_volume (), restore_data_size ==> %ld\n", backup_file_size);
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "cubrid_backup_api.h"
+
+#define LEVEL_COUNT (3)
+
+typedef struct level_writer LEVEL_WRITER;
+struct level_writer
+{
+    pthread_t thread;
+    int backup_level;
+    char backup_file_path[512];
+    long long restore_data_size;
+    int result;
+};
+
+static CUBRID_RESTORE_INFO cub_restore_info;
+static void *cub_restore_handle = NULL;
+
+void usage ()
+{
+    printf ("./restore_tc05 [DB_NAME] [BACKUP_PATH] [RESTORE_PATH]\n\n");
+    printf ("ex)\n");
+    printf ("restore (all levels) ==> ./restore_tc05 demodb ./backup_dir ./restore_dir\n");
+    printf ("the backup files demodb_bk0v000 ~ demodb_bk%dv000 are restored in one session\n", LEVEL_COUNT - 1);
+}
+
+void set_restore_info (CUBRID_RESTORE_INFO *restore_info, char *db_name, char *restore_path)
+{
+    restore_info->db_name          = db_name;
+    restore_info->backup_level     = CUBRID_RESTORE_ALL_LEVELS;
+    restore_info->restore_type     = RESTORE_TO_FILE;
+    restore_info->backup_file_path = restore_path;
+}
+
+// each thread writes the backup file of one level
+void *write_level (void *arg)
+{
+    LEVEL_WRITER *level_writer = (LEVEL_WRITER *)arg;
+    char restore_data_buffer[4096];
+    size_t restore_data_size;
+    FILE *backup_fp;
+
+    level_writer->result = -1;
+
+    backup_fp = fopen (level_writer->backup_file_path, "r");
+    if (backup_fp == NULL)
+    {
+        return NULL;
+    }
+
+    while ((restore_data_size = fread (restore_data_buffer, 1, 4096, backup_fp)) > 0)
+    {
+        if (-1 == cubrid_restore_write (cub_restore_handle, level_writer->backup_level, restore_data_buffer, restore_data_size))
+        {
+            fclose (backup_fp);
+            return NULL;
+        }
+
+        level_writer->restore_data_size += restore_data_size;
+    }
+
+    fclose (backup_fp);
+
+    level_writer->result = 0;
+
+    return NULL;
+}
+
+int main (int argc, char *argv[])
+{
+    LEVEL_WRITER level_writers[LEVEL_COUNT];
+    char restore_data_buffer[4096];
+    int i;
+
+    if (argc != 4)
+    {
+        usage ();
+        exit (1);
+    }
+
+    set_restore_info (&cub_restore_info, argv[1], argv[3]);
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_initialize ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_restore_begin (&cub_restore_info, &cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_begin ()\n");
+        exit (1);
+    }
+
+    // out of range level
+    memset (restore_data_buffer, 0, sizeof (restore_data_buffer));
+
+    if (-1 != cubrid_restore_write (cub_restore_handle, LEVEL_COUNT, restore_data_buffer, 4096))
+    {
+        printf ("[NOK] cubrid_restore_write () with an invalid backup_level\n");
+        exit (1);
+    }
+
+    for (i = 0; i < LEVEL_COUNT; i ++)
+    {
+        level_writers[i].backup_level      = i;
+        level_writers[i].restore_data_size = 0;
+
+        snprintf (level_writers[i].backup_file_path, sizeof (level_writers[i].backup_file_path),
+                  "%s/%s_bk%dv000", argv[2], argv[1], i);
+
+        if (0 != pthread_create (&level_writers[i].thread, NULL, write_level, &level_writers[i]))
+        {
+            printf ("[NOK] failed to create a thread\n");
+            exit (1);
+        }
+    }
+
+    for (i = 0; i < LEVEL_COUNT; i ++)
+    {
+        pthread_join (level_writers[i].thread, NULL);
+
+        if (-1 == level_writers[i].result)
+        {
+            printf ("[NOK] failed the execution of cubrid_restore_write (), backup_level ==> %d\n", i);
+            exit (1);
+        }
+    }
+
+    if (-1 == cubrid_restore_end (cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_end ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_finalize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_finalize ()\n");
+        exit (1);
+    }
+
+    for (i = 0; i < LEVEL_COUNT; i ++)
+    {
+        printf ("[OK] cubrid_restore_write (), backup_level ==> %d, restore_data_size ==> %lld\n",
+                i, level_writers[i].restore_data_size);
+    }
+
+    return 0;
+}
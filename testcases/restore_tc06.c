@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#include "cubrid_backup_api.h"
+
+void usage ()
+{
+    printf ("./restore_tc06 [DB_NAME] [BACKUP_LEVEL] [BACKUP_FILE_PATH]\n\n");
+    printf ("ex)\n");
+    printf ("restore (full) ==> ./restore_tc06 demodb 0 ./backup_dir/demodb_bk0v000\n");
+    printf ("the backup file is streamed into cubrid restoredb, the database server must be stopped\n");
+    printf ("the fifo is made in the directory of the backup file, which must survive the restore\n");
+}
+
+void set_restore_info (CUBRID_RESTORE_INFO *restore_info, char *db_name, char *backup_level, char *fifo_dir)
+{
+    restore_info->db_name          = db_name;
+    restore_info->backup_level     = atoi (backup_level);
+    restore_info->restore_type     = RESTORE_TO_DB;
+    restore_info->up_to_date       = NULL;
+    restore_info->backup_file_path = fifo_dir;
+}
+
+int main (int argc, char *argv[])
+{
+    CUBRID_RESTORE_INFO cub_restore_info;
+    void *cub_restore_handle = NULL;
+    void *other_restore_handle = NULL;
+    char restore_data_buffer[4096];
+    long long total_restore_data_size = 0;
+    size_t restore_data_size;
+    char backup_file_path[512];
+    struct stat backup_stat;
+    FILE *backup_fp;
+
+    if (argc != 4)
+    {
+        usage ();
+        exit (1);
+    }
+
+    // the fifo directory holds a regular file of the same name as the fifo, the backup file itself
+    snprintf (backup_file_path, sizeof (backup_file_path), "%s", argv[3]);
+
+    set_restore_info (&cub_restore_info, argv[1], argv[2], dirname (backup_file_path));
+
+    backup_fp = fopen (argv[3], "r");
+    if (backup_fp == NULL)
+    {
+        printf ("[NOK] failed to open backup file\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_initialize ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_restore_begin (&cub_restore_info, &cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_begin ()\n");
+        exit (1);
+    }
+
+    // only one cubrid restoredb per database
+    if (-1 != cubrid_restore_begin (&cub_restore_info, &other_restore_handle))
+    {
+        printf ("[NOK] cubrid_restore_begin () of the same database\n");
+        exit (1);
+    }
+
+    while ((restore_data_size = fread (restore_data_buffer, 1, 4096, backup_fp)) > 0)
+    {
+        if (-1 == cubrid_restore_write (cub_restore_handle, cub_restore_info.backup_level, restore_data_buffer, restore_data_size))
+        {
+            printf ("[NOK] failed the execution of cubrid_restore_write ()\n");
+            exit (1);
+        }
+
+        total_restore_data_size += restore_data_size;
+    }
+
+    fclose (backup_fp);
+
+    // waits for cubrid restoredb
+    if (-1 == cubrid_restore_end (cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_end ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_finalize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_finalize ()\n");
+        exit (1);
+    }
+
+    if (0 != stat (argv[3], &backup_stat) || !S_ISREG (backup_stat.st_mode) || backup_stat.st_size != total_restore_data_size)
+    {
+        printf ("[NOK] the backup file next to the fifo is lost\n");
+        exit (1);
+    }
+
+    printf ("[OK] RESTORE_TO_DB, restore_data_size ==> %lld\n", total_restore_data_size);
+
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "cubrid_backup_api.h"
+
+#define THREAD_COUNT (4)
+#define CHUNK_SIZE   (64 * 1024 + 100)
+
+typedef struct range_writer RANGE_WRITER;
+struct range_writer
+{
+    pthread_t thread;
+    int thread_index;
+    int result;
+};
+
+static CUBRID_RESTORE_INFO cub_restore_info;
+static void *cub_restore_handle = NULL;
+static char *backup_data;
+static long backup_file_size;
+static int chunk_count;
+static int *chunk_order;
+
+void usage ()
+{
+    printf ("./restore_tc07 [DB_NAME] [BACKUP_LEVEL] [BACKUP_FILE_PATH] [RESTORE_PATH]\n\n");
+    printf ("ex)\n");
+    printf ("restore (full) ==> ./restore_tc07 demodb 0 ./backup_dir/demodb_bk0v000 ./restore_dir\n");
+    printf ("the backup file is written in shuffled chunks by %d threads\n", THREAD_COUNT);
+}
+
+void set_restore_info (CUBRID_RESTORE_INFO *restore_info, char *db_name, char *backup_level, char *restore_path)
+{
+    restore_info->db_name          = db_name;
+    restore_info->backup_level     = atoi (backup_level);
+    restore_info->restore_type     = RESTORE_TO_FILE;
+    restore_info->backup_file_path = restore_path;
+}
+
+// begins a session whose ranges must cover the whole backup file
+void begin_range_restore (void)
+{
+    if (-1 == cubrid_restore_begin (&cub_restore_info, &cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_begin ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_restore_set_expected_size (cub_restore_handle, backup_file_size))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_set_expected_size ()\n");
+        exit (1);
+    }
+}
+
+int write_chunk (int chunk_index)
+{
+    long offset = (long)chunk_index * CHUNK_SIZE;
+    long size = backup_file_size - offset < CHUNK_SIZE ? backup_file_size - offset : CHUNK_SIZE;
+
+    return cubrid_restore_pwrite (cub_restore_handle, cub_restore_info.backup_level, offset, backup_data + offset, size);
+}
+
+// each thread writes every THREAD_COUNT-th chunk of the shuffled order
+void *write_ranges (void *arg)
+{
+    RANGE_WRITER *range_writer = (RANGE_WRITER *)arg;
+    int i;
+
+    range_writer->result = -1;
+
+    for (i = range_writer->thread_index; i < chunk_count; i += THREAD_COUNT)
+    {
+        if (-1 == write_chunk (chunk_order[i]))
+        {
+            return NULL;
+        }
+    }
+
+    // the same range again, as a retried download would
+    if (-1 == write_chunk (chunk_order[range_writer->thread_index % chunk_count]))
+    {
+        return NULL;
+    }
+
+    range_writer->result = 0;
+
+    return NULL;
+}
+
+int main (int argc, char *argv[])
+{
+    RANGE_WRITER range_writers[THREAD_COUNT];
+    FILE *backup_fp;
+    int tmp;
+    int i, j;
+
+    if (argc != 5)
+    {
+        usage ();
+        exit (1);
+    }
+
+    backup_fp = fopen (argv[3], "r");
+    if (backup_fp == NULL)
+    {
+        printf ("[NOK] failed to open backup file\n");
+        exit (1);
+    }
+
+    fseek (backup_fp, 0, SEEK_END);
+    backup_file_size = ftell (backup_fp);
+    fseek (backup_fp, 0, SEEK_SET);
+
+    backup_data = (char *)malloc (backup_file_size);
+    if (backup_data == NULL || backup_file_size != fread (backup_data, 1, backup_file_size, backup_fp))
+    {
+        printf ("[NOK] failed to read backup file\n");
+        exit (1);
+    }
+
+    fclose (backup_fp);
+
+    chunk_count = (backup_file_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunk_order = (int *)malloc (chunk_count * sizeof (int));
+
+    for (i = 0; i < chunk_count; i ++)
+    {
+        chunk_order[i] = i;
+    }
+
+    srand (1);
+
+    for (i = chunk_count - 1; i > 0; i --)
+    {
+        j = rand () % (i + 1);
+
+        tmp = chunk_order[i];
+        chunk_order[i] = chunk_order[j];
+        chunk_order[j] = tmp;
+    }
+
+    set_restore_info (&cub_restore_info, argv[1], argv[2], argv[4]);
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_initialize ()\n");
+        exit (1);
+    }
+
+    // test #1 - a missing chunk must fail cubrid_restore_end ()
+    begin_range_restore ();
+
+    for (i = 1; i < chunk_count; i ++)
+    {
+        if (-1 == write_chunk (i))
+        {
+            printf ("[NOK] failed the execution of cubrid_restore_pwrite ()\n");
+            exit (1);
+        }
+    }
+
+    if (-1 != cubrid_restore_set_expected_size (cub_restore_handle, backup_file_size))
+    {
+        printf ("[NOK] cubrid_restore_set_expected_size () after cubrid_restore_pwrite ()\n");
+        exit (1);
+    }
+
+    if (-1 != cubrid_restore_write (cub_restore_handle, cub_restore_info.backup_level, backup_data, CHUNK_SIZE))
+    {
+        printf ("[NOK] cubrid_restore_write () after cubrid_restore_pwrite ()\n");
+        exit (1);
+    }
+
+    if (-1 != cubrid_restore_end (cub_restore_handle))
+    {
+        printf ("[NOK] cubrid_restore_end () with a gap\n");
+        exit (1);
+    }
+
+    printf ("[OK] cubrid_restore_end () with a gap\n");
+
+    // test #2 - shuffled chunks from many threads
+    begin_range_restore ();
+
+    for (i = 0; i < THREAD_COUNT; i ++)
+    {
+        range_writers[i].thread_index = i;
+
+        if (0 != pthread_create (&range_writers[i].thread, NULL, write_ranges, &range_writers[i]))
+        {
+            printf ("[NOK] failed to create a thread\n");
+            exit (1);
+        }
+    }
+
+    for (i = 0; i < THREAD_COUNT; i ++)
+    {
+        pthread_join (range_writers[i].thread, NULL);
+
+        if (-1 == range_writers[i].result)
+        {
+            printf ("[NOK] failed the execution of cubrid_restore_pwrite ()\n");
+            exit (1);
+        }
+    }
+
+    if (-1 == cubrid_restore_end (cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_end ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_finalize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_finalize ()\n");
+        exit (1);
+    }
+
+    printf ("[OK] cubrid_restore_pwrite (), restore_data_size ==> %ld, chunk_count ==> %d\n", backup_file_size, chunk_count);
+
+    free (chunk_order);
+    free (backup_data);
+
+    return 0;
+}
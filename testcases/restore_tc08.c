@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "cubrid_backup_api.h"
+
+static CUBRID_RESTORE_INFO cub_restore_info;
+static char *backup_data;
+static long backup_file_size;
+
+void usage ()
+{
+    printf ("./restore_tc08 [DB_NAME] [BACKUP_LEVEL] [BACKUP_FILE_PATH] [RESTORE_PATH]\n\n");
+    printf ("ex)\n");
+    printf ("restore (full) ==> ./restore_tc08 demodb 0 ./backup_dir/demodb_bk0v000 ./restore_dir\n");
+    printf ("the backup file is restored in three resumable sessions, the second one is killed\n");
+    printf ("[restore] checkpoint_size of cubrid_backup.conf must be smaller than a quarter of the backup file\n");
+}
+
+void set_restore_info (CUBRID_RESTORE_INFO *restore_info, char *db_name, char *backup_level, char *restore_path)
+{
+    restore_info->db_name          = db_name;
+    restore_info->backup_level     = atoi (backup_level);
+    restore_info->restore_type     = RESTORE_TO_FILE;
+    restore_info->backup_file_path = restore_path;
+}
+
+// begins a resumable session and writes [resume offset, end_offset)
+void *begin_and_write (long end_offset, long long *resume_offset)
+{
+    void *cub_restore_handle = NULL;
+    long offset;
+    long size;
+
+    if (-1 == cubrid_backup_initialize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_initialize ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_restore_begin_resumable (&cub_restore_info, &cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_begin_resumable ()\n");
+        exit (1);
+    }
+
+    *resume_offset = cubrid_restore_get_resume_offset (cub_restore_handle);
+
+    if (*resume_offset == -1 || *resume_offset > end_offset)
+    {
+        printf ("[NOK] cubrid_restore_get_resume_offset (), resume_offset ==> %lld\n", *resume_offset);
+        exit (1);
+    }
+
+    // a resumed session keeps the size recorded in the checkpoint
+    if (*resume_offset != 0 && -1 != cubrid_restore_set_expected_size (cub_restore_handle, backup_file_size + 1))
+    {
+        printf ("[NOK] cubrid_restore_set_expected_size () with a different size\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_restore_set_expected_size (cub_restore_handle, backup_file_size))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_set_expected_size ()\n");
+        exit (1);
+    }
+
+    for (offset = *resume_offset; offset < end_offset; offset += size)
+    {
+        size = end_offset - offset < 4096 ? end_offset - offset : 4096;
+
+        if (-1 == cubrid_restore_write (cub_restore_handle, cub_restore_info.backup_level, backup_data + offset, size))
+        {
+            printf ("[NOK] failed the execution of cubrid_restore_write ()\n");
+            exit (1);
+        }
+    }
+
+    return cub_restore_handle;
+}
+
+int main (int argc, char *argv[])
+{
+    void *cub_restore_handle = NULL;
+    char checkpoint_file[512];
+    long long resume_offset;
+    long half_offset;
+    FILE *backup_fp;
+    pid_t pid;
+    int status;
+
+    if (argc != 5)
+    {
+        usage ();
+        exit (1);
+    }
+
+    backup_fp = fopen (argv[3], "r");
+    if (backup_fp == NULL)
+    {
+        printf ("[NOK] failed to open backup file\n");
+        exit (1);
+    }
+
+    fseek (backup_fp, 0, SEEK_END);
+    backup_file_size = ftell (backup_fp);
+    fseek (backup_fp, 0, SEEK_SET);
+
+    backup_data = (char *)malloc (backup_file_size);
+    if (backup_data == NULL || backup_file_size != fread (backup_data, 1, backup_file_size, backup_fp))
+    {
+        printf ("[NOK] failed to read backup file\n");
+        exit (1);
+    }
+
+    fclose (backup_fp);
+
+    set_restore_info (&cub_restore_info, argv[1], argv[2], argv[4]);
+
+    snprintf (checkpoint_file, sizeof (checkpoint_file), "%s/%s_bk%sv000.ckpt", argv[4], argv[1], argv[2]);
+
+    // the checkpoint is aligned to 4096
+    half_offset = backup_file_size / 2 / 4096 * 4096;
+
+    // test #1 - cubrid_restore_end () before the expected size leaves a checkpoint
+    cub_restore_handle = begin_and_write (backup_file_size / 2, &resume_offset);
+
+    if (resume_offset != 0)
+    {
+        printf ("[NOK] cubrid_restore_get_resume_offset (), resume_offset ==> %lld, expected ==> 0\n", resume_offset);
+        exit (1);
+    }
+
+    if (-1 == cubrid_restore_end (cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_end ()\n");
+        exit (1);
+    }
+
+    cubrid_backup_finalize ();
+
+    if (0 != access (checkpoint_file, F_OK))
+    {
+        printf ("[NOK] no checkpoint after an incomplete restore\n");
+        exit (1);
+    }
+
+    printf ("[OK] incomplete restore, checkpoint ==> %s\n", checkpoint_file);
+
+    // test #2 - a session killed in the middle leaves the periodic checkpoints behind
+    pid = fork ();
+    if (pid == 0)
+    {
+        begin_and_write (backup_file_size / 4 * 3, &resume_offset);
+
+        if (resume_offset != half_offset)
+        {
+            printf ("[NOK] cubrid_restore_get_resume_offset (), resume_offset ==> %lld, expected ==> %ld\n",
+                    resume_offset, half_offset);
+            exit (1);
+        }
+
+        // dies without cubrid_restore_end ()
+        kill (getpid (), SIGKILL);
+    }
+
+    if (pid == -1 || pid != waitpid (pid, &status, 0) || !WIFSIGNALED (status) || WTERMSIG (status) != SIGKILL)
+    {
+        printf ("[NOK] killed restore session\n");
+        exit (1);
+    }
+
+    printf ("[OK] killed restore session\n");
+
+    // test #3 - the last session resumes from a checkpoint written by the killed session,
+    //           then writes the rest and removes the checkpoint
+    cub_restore_handle = begin_and_write (backup_file_size, &resume_offset);
+
+    if (resume_offset <= half_offset || resume_offset > backup_file_size / 4 * 3)
+    {
+        printf ("[NOK] cubrid_restore_get_resume_offset (), resume_offset ==> %lld, expected ==> (%ld, %ld]\n",
+                resume_offset, half_offset, backup_file_size / 4 * 3);
+        exit (1);
+    }
+
+    if (-1 == cubrid_restore_end (cub_restore_handle))
+    {
+        printf ("[NOK] failed the execution of cubrid_restore_end ()\n");
+        exit (1);
+    }
+
+    if (-1 == cubrid_backup_finalize ())
+    {
+        printf ("[NOK] failed the execution of cubrid_backup_finalize ()\n");
+        exit (1);
+    }
+
+    if (0 == access (checkpoint_file, F_OK))
+    {
+        printf ("[NOK] checkpoint after a complete restore\n");
+        exit (1);
+    }
+
+    printf ("[OK] cubrid_restore_get_resume_offset (), resume_offset ==> %lld, restore_data_size ==> %ld\n",
+            resume_offset, backup_file_size);
+
+    free (backup_data);
+
+    return 0;
+}
@@ -105,6 +105,64 @@ echo "==run restore_tc03"
 ./restore_tc03 ${db_name} > restore_tc03_result 2>&1 
 echo ""
 
+echo "==run restore_tc04"
+./restore_tc04 $db_name 0 ./backup_dir/${db_name}_bk0v000 ./restore_dir/ > restore_tc04_result 2>&1
+if [ -z "`cat ./restore_dir/${db_name}_bk0v00[0-2] | cmp ./backup_dir/${db_name}_bk0v000 -`" ]; then
+	echo "[OK] compare restore volumes of level 0" >> restore_tc04_result
+else
+	echo "[NOK] compare restore volumes of level 0" >> restore_tc04_result
+fi
+echo ""
+
+echo "==run restore_tc05"
+rm -rf ./restore_dir/*
+./restore_tc05 $db_name ./backup_dir ./restore_dir/ > restore_tc05_result 2>&1
+for i in 0 1 2; do
+	if [ -z "`cmp ./backup_dir/${db_name}_bk${i}v000 ./restore_dir/${db_name}_bk${i}v000`" ]; then
+		echo "[OK] compare restore file of level $i" >> restore_tc05_result
+	else
+		echo "[NOK] compare restore file of level $i" >> restore_tc05_result
+	fi
+done
+echo ""
+
+echo "==run restore_tc06"
+cubrid server stop $db_name
+rm -rf $db_name
+./restore_tc06 $db_name 0 ./backup_dir/${db_name}_bk0v000 > restore_tc06_result 2>&1
+cubrid server start $db_name
+if [ `cubrid server status $db_name |grep "Server $db_name" |wc -l` -eq 0 ]; then
+	echo "[NOK] run restoredb" >> restore_tc06_result
+	cubrid deletedb $db_name
+	cubrid createdb -r --db-volume-size=100M --log-volume-size=100M $db_name en_US
+	cubrid server start $db_name
+else
+	echo "[OK] run restoredb" >> restore_tc06_result
+fi
+echo ""
+
+echo "==run restore_tc07"
+rm -rf ./restore_dir/*
+./restore_tc07 $db_name 0 ./backup_dir/${db_name}_bk0v000 ./restore_dir/ > restore_tc07_result 2>&1
+if [ -z "`cmp ./backup_dir/${db_name}_bk0v000 ./restore_dir/${db_name}_bk0v000`" ]; then
+	echo "[OK] compare restore file of level 0" >> restore_tc07_result
+else
+	echo "[NOK] compare restore file of level 0" >> restore_tc07_result
+fi
+echo ""
+
+echo "==run restore_tc08"
+rm -rf ./restore_dir/*
+cp cubrid_backup.conf $CUBRID/conf/
+./restore_tc08 $db_name 0 ./backup_dir/${db_name}_bk0v000 ./restore_dir/ > restore_tc08_result 2>&1
+rm -rf $CUBRID/conf/cubrid_backup.conf
+if [ -z "`cmp ./backup_dir/${db_name}_bk0v000 ./restore_dir/${db_name}_bk0v000`" ]; then
+	echo "[OK] compare restore file of level 0" >> restore_tc08_result
+else
+	echo "[NOK] compare restore file of level 0" >> restore_tc08_result
+fi
+echo ""
+
 echo "==run backup_tc04"
 rm -rf $CUBRID/log/cubrid_utility.log
 ./backup_tc04 $db_name 0 -1 -1 -1 -1 ./backup_dir/${db_name}_bk0v000 > backup_tc04_result 2>&1 
@@ -229,12 +287,78 @@ sleep 1
 
 echo ""
 
+echo "==run backup_tc05"
+./backup_tc05 $db_name 0 ./backup_dir/${db_name}_bk0v000 > backup_tc05_result 2>&1 
+sleep 1
+
+echo ""
+cubrid server stop $db_name
+rm -rf $db_name
+restoredb_exe "-B ./backup_dir -l 0"
+cubrid server start $db_name
+if [ `cubrid server status $db_name |grep "Server $db_name" |wc -l` -eq 0 ]; then
+	echo "[NOK] run restoredb" >> backup_tc05_result
+	cubrid deletedb $db_name
+	cubrid createdb -r --db-volume-size=100M --log-volume-size=100M $db_name en_US
+	cubrid server start $db_name
+else
+	echo "[OK] run restoredb" >> backup_tc05_result
+fi
+rm -rf $CUBRID/log/cubrid_utility.log
+sleep 1
+
+echo ""
+
+echo "==run backup_tc06"
+./backup_tc06 $db_name 0 ./backup_dir/${db_name}_bk0v000 > backup_tc06_result 2>&1 
+sleep 1
+
+echo ""
+cubrid server stop $db_name
+rm -rf $db_name
+restoredb_exe "-B ./backup_dir -l 0"
+cubrid server start $db_name
+if [ `cubrid server status $db_name |grep "Server $db_name" |wc -l` -eq 0 ]; then
+	echo "[NOK] run restoredb" >> backup_tc06_result
+	cubrid deletedb $db_name
+	cubrid createdb -r --db-volume-size=100M --log-volume-size=100M $db_name en_US
+	cubrid server start $db_name
+else
+	echo "[OK] run restoredb" >> backup_tc06_result
+fi
+rm -rf $CUBRID/log/cubrid_utility.log
+sleep 1
+
+echo ""
+
+echo "==run backup_tc07"
+./backup_tc07 $db_name 0 ./backup_dir/${db_name}_bk0v000 > backup_tc07_result 2>&1 
+sleep 1
+
+echo ""
+cubrid server stop $db_name
+rm -rf $db_name
+restoredb_exe "-B ./backup_dir -l 0"
+cubrid server start $db_name
+if [ `cubrid server status $db_name |grep "Server $db_name" |wc -l` -eq 0 ]; then
+	echo "[NOK] run restoredb" >> backup_tc07_result
+	cubrid deletedb $db_name
+	cubrid createdb -r --db-volume-size=100M --log-volume-size=100M $db_name en_US
+	cubrid server start $db_name
+else
+	echo "[OK] run restoredb" >> backup_tc07_result
+fi
+rm -rf $CUBRID/log/cubrid_utility.log
+sleep 1
+
+echo ""
+
 echo "==run conf_test"
 echo ""
 sh conf_test.sh $db_name
 cubrid server stop $db_name
 
-for i in $(seq 1 10); do
+for i in $(seq 1 12); do
 	restoredb_exe "-B ./backup_dir/$i"
 	if [ `echo $expect_val | grep "The following" | wc -l` -eq 1 ]; then
 		echo "[NOK] set cubrid_backup.conf : restoredb_exe ($i)" >> conf_test_result